@@ -74,6 +74,7 @@ UNIX_PROGRAMS = \
   rd              \
   redo            \
   remplace        \
+  tee             \
   trim            \
   update          \
   Which		  \
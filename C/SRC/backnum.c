@@ -60,6 +60,12 @@
 *    2020-11-05 JFL Moved copydate() to SysLib, adding ns resolution.         *
 *                   Version 2.3.					      *
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 2.3.1.		      *
+*    2026-10-18 JFL Preallocate the backup file. Copy with a larger buffer.   *
+*                   Added option -N to avoid leaving the copy in the cache.   *
+*                   Version 2.4.					      *
+*    2026-10-18 JFL Fixed -N dropping the whole source cache after each block.*
+*                   Delete the backup file if there's not enough space for it.*
+*                   Version 2.4.1.                                            *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -67,8 +73,8 @@
 
 #define PROGRAM_DESCRIPTION "Create a numbered backup copy of a file"
 #define PROGRAM_NAME    "backnum"
-#define PROGRAM_VERSION "2.3.1"
-#define PROGRAM_DATE    "2022-10-19"
+#define PROGRAM_VERSION "2.4.1"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -86,7 +92,7 @@
 #ifndef FNM_MATCH /* fnmatch.h always defines FNM_NOMATCH, but not always FNM_MATCH */
 #define FNM_MATCH 0
 #endif
-#include <unistd.h>		/* For access() */
+#include <unistd.h>		/* For access() and unlink() */
 /* SysToolsLib include files */
 #include "debugm.h"		/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"		/* SysLib helper routines for main() */
@@ -165,6 +171,7 @@ void _makepath(char *buf, const char *d, const char *p, const char *n, const cha
 int iVerbose = FALSE;
 int iQuiet = FALSE;
 int iExec = TRUE;
+int iNoCache = FALSE;	/* Don't leave the copied data in the cache */
 #ifdef _MSDOS
 int iAppend = 0;	/* Replace the extension */
 #else
@@ -238,6 +245,11 @@ int main(int argc, char *argv[]) {
 	continue;
       }
 #endif
+      if (   streq(argv[i]+1, "N")		/* -N: Don't leave data in the cache */
+	  || streq(argv[i]+1, "-nocache")) {
+	iNoCache = TRUE;
+	continue;
+      }
       if (streq(argv[i]+1, "q")) {		/* -q: Be quiet */
 	iQuiet = TRUE;
 	continue;
@@ -450,6 +462,7 @@ Switches:\n\
   -d      Output debug information.\n"
 #endif
 "\
+  -N      Don't leave the data copied in the system file cache\n\
   -q      Be quiet\n\
   -v      Display verbose information\n\
   -X      Display the backup file name, but don't create it.\n\
@@ -479,10 +492,18 @@ Switches:\n\
 |    1992/05/20 JFL Adapted to Microsoft C.                                   |
 |    1993/10/19 JFL Cleanup for reuse in other programs                       |
 |    2011/05/12 JFL Use an OS-independant method to copy the file time.       |
+|    2026-10-18 JFL Preallocate the target file. Added the no-cache mode.     |
+|    2026-10-18 JFL Delete the target file if it cannot be preallocated.      |
+|		    Drop only the last block read from the source cache.      |
 *									      *
 \*---------------------------------------------------------------------------*/
 
+#ifdef _MSDOS
 #define BUFFERSIZE 4096
+#else
+#define BUFFERSIZE (256L * 1024L)
+#endif
+#define NOCACHE_WINDOW (8L * 1024L * 1024L) /* Write-behind window in no-cache mode */
 
 #ifdef _MSC_VER
 #pragma warning(disable:4706) /* Ignore the "assignment within conditional expression" warning */
@@ -493,6 +514,9 @@ int fcopy(char *name2, char *name1) {
   int tocopy;             /* Number of bytes to copy in one pass */
   static char *buffer;    /* Pointer on the intermediate copy buffer */
   int err;
+  struct stat sStat;
+  off_t llDone = 0;       /* Number of bytes copied so far */
+  WRITEBEHIND wb;         /* Write-behind state in no-cache mode */
 
   DEBUG_ENTER(("fcopy(\"%s\", \"%s\");\n", name2, name1));
 
@@ -517,6 +541,16 @@ int fcopy(char *name2, char *name1) {
     return 3;
   }
 
+  /* Reserve the space for the whole file, to avoid fragmenting it */
+  if ((!fstat(fileno(pfs), &sStat)) && PreallocFile(fileno(pfd), sStat.st_size)) {
+    fclose(pfs);
+    fclose(pfd);
+    unlink(name2); /* Avoid leaving an empty file on the target */
+    DEBUG_LEAVE(("return 3; // Not enough space for the destination file\n"));
+    return 3;
+  }
+  InitWriteBehind(&wb, fileno(pfd), iNoCache ? NOCACHE_WINDOW : 0, WB_NOCACHE);
+
   while ((tocopy = (int)fread(buffer, 1, BUFFERSIZE, pfs))) {
     if (!fwrite(buffer, tocopy, 1, pfd)) {
       fclose(pfs);
@@ -524,10 +558,17 @@ int fcopy(char *name2, char *name1) {
       DEBUG_LEAVE(("return 3; // Cannot write to destination file\n"));
       return 3;
     }
+    llDone += tocopy;
+    if (iNoCache) {
+      fflush(pfd);
+      WriteBehind(&wb, llDone);
+      DropCache(fileno(pfs), llDone - tocopy, tocopy); /* Drop only the new block */
+    }
   }
 
   /* Flush buffers into the destination file, */
   fflush(pfd);
+  EndWriteBehind(&wb);
   /* and give the same date than the source file */
 
   fclose(pfs);
@@ -48,6 +48,11 @@
 *    2022-12-12 JFL Use getline() instead of fgets(). Version 3.0.3.	      *
 *		    This makes the input capable of reading any line size.    *
 *		    TODO: Remove the line size limitation on the output too.  *
+*    2026-10-18 JFL Use SysLib's vectorized ExpandTabs() in detab(). It       *
+*		    works on a copy of the line, instead of reading and       *
+*		    writing 256 bytes in the getline() buffer, which may be   *
+*		    smaller. Do not move the getline() buffer pointer when    *
+*		    skipping form feeds and backspaces. Version 3.0.4.	      *
 *		    							      *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -55,8 +60,8 @@
 
 #define PROGRAM_DESCRIPTION "Remove Form Feeds from a text"
 #define PROGRAM_NAME    "deffeed"
-#define PROGRAM_VERSION "3.0.3"
-#define PROGRAM_DATE    "2022-12-12"
+#define PROGRAM_VERSION "3.0.4"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -130,6 +135,7 @@ char *strlwr(char *psz)    /* Convenient Microsoft library routine not available
 
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
+#include "parfilter.h"	/* SysLib text filtering routines */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 /* Global variables */
@@ -142,7 +148,7 @@ char *buffer = NULL;
 /* Forward references */
 
 void usage(void);
-int detab(char *line, int length, int tab);
+char *detab(char *line, int length, int tab);
 int output_line(int np, int nl, char *format, char *text, FILE *fdest);
 
 /*---------------------------------------------------------------------------*\
@@ -176,6 +182,7 @@ int main(int argc, char *argv[]) {
   int fptp0 = 0;      /* Same for physical pages in multicolumn operation */
   int length;         /* Length of above buffer */
   char *pline = NULL; /* Pointer on the line buffer */
+  char *ptext;        /* Pointer on the text to output in that line */
   size_t lSize = 0;   /* Line size */
   int nl = 0;         /* Current line number (0 to lpp-1) */
   int np = 0;         /* Current page number, modulo modnp */
@@ -457,9 +464,10 @@ int main(int argc, char *argv[]) {
     }
 
     length = BUFSIZE;
+    ptext = pline;
 
-    while (*pline == '\f') {            /* If line begins with a form feed */
-      pline += 1;
+    while (*ptext == '\f') {            /* If line begins with a form feed */
+      ptext += 1;
       length -= 1;
       if (!top_without_ff) { /* Except in the case where we're at top line without a form-feed... */
 	   		     /*  ... fill-up the rest of the page with blank lines.		 */
@@ -474,13 +482,17 @@ int main(int argc, char *argv[]) {
       }
       top_without_ff = FALSE; /* Do this exception only once. (We've had a form-feed now.) */
     }
-    if ((nl == 0) && (!*pline) && (top_without_ff == FALSE)) continue; /* Ignore CRLF immediately following a FF */
-    if (*pline == '\b') {
-      pline += 1;     /* Remove backspaces at column 0 */
+    if ((nl == 0) && (!*ptext) && (top_without_ff == FALSE)) continue; /* Ignore CRLF immediately following a FF */
+    if (*ptext == '\b') {
+      ptext += 1;     /* Remove backspaces at column 0 */
       length -= 1;
     }
-    detab(pline, length, tab);
-    output_line(np, nl, format, pline, fdest);
+    ptext = detab(ptext, length, tab);
+    if (!ptext) {
+      fprintf(stderr, "Not enough memory to run.\n");
+      exit(1);
+    }
+    output_line(np, nl, format, ptext, fdest);
     nl += 1;
     if (nl == lpp) {
       DEBUG_CODE(fprintf(stderr, "Reached end of page %d on line %d. Moving to top of next page.\n", npt, nl);)
@@ -615,42 +627,30 @@ Options:\n\
 *                                                                             *
 |   Function:	    detab						      |
 |									      |
-|   Description:							      |
+|   Description:    Convert tabs to spaces				      |
 |									      |
-|   Parameters: 							      |
+|   Parameters:     char *line		The line, without its line end	      |
+|		    int length		Maximum output size, including NUL    |
+|		    int tab		Number of columns between tab stops   |
 |									      |
-|   Returns:								      |
+|   Returns:	    The converted line, in a static buffer. NULL if no memory |
 |                                                                             |
 |   History:								      |
+|    2026-10-18 JFL Use ExpandTabs() and return a copy.			      |
 *									      *
 \*---------------------------------------------------------------------------*/
 
-int detab(char *line, int length, int tab)
+char *detab(char *line, int length, int tab)
     {
-    char templine[BUFSIZE];
-    int i, j, itab;
-
-    memcpy(templine, line, BUFSIZE);
+    static PFBUF out = {0};     /* Reused for all lines */
+    int iCol = 0;
 
-    for (i=j=itab=0; j<length-tab; i++)
-        {
-        switch(templine[i])
-            {
-            case '\t':
-                while (itab++<tab) line[j++] = ' ';
-                itab = 0;
-                break;
-            default:
-                line[j++] = templine[i];
-                itab += 1;
-                break;
-            }
-        if (itab >= tab) itab = 0;
-        if (!templine[i]) break;
-        }
-    line[length-1] = '\0';
+    out.nBuf = 0;
+    if (ExpandTabs(line, strlen(line), &out, tab, &iCol) < 0) return NULL;
+    if (out.nBuf > (size_t)(length-1)) out.nBuf = length-1; /* output_line() is limited to BUFSIZE */
+    if (PFWrite(&out, "", 1)) return NULL;
 
-    return 0;
+    return out.pBuf;
     }
 
 /*---------------------------------------------------------------------------*\
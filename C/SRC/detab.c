@@ -52,6 +52,20 @@
 *    2022-10-16 JFL Removed an unused variable.                               *
 *		    Version 3.3.2.					      *
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 3.3.3.		      *
+*    2026-10-18 JFL Detab large files in parallel chunks. Added option -j.    *
+*		    Version 3.4.					      *
+*    2026-10-18 JFL Also detab small files and pipes with the same routine,   *
+*		    using SysLib's StreamFilter() on large blocks, instead of *
+*		    an fgetc() and fputc() loop. Version 3.4.1.		      *
+*    2026-10-18 JFL Use SysLib's vectorized ExpandTabs(). Version 3.4.2.      *
+*    2026-10-18 JFL Added option -r to detab all files in a directory tree in *
+*		    place, with options -n and -x to select them.	      *
+*		    Version 3.5.					      *
+*    2026-10-18 JFL When converting a file in place, first check if anything  *
+*		    changes, and if not, do not write anything.		      *
+*		    Version 3.5.1.					      *
+*    2026-10-18 JFL Report a missing directory name after option -r as an     *
+*		    error. Version 3.5.2.				      *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -59,8 +73,8 @@
 
 #define PROGRAM_DESCRIPTION "Convert tabs to spaces"
 #define PROGRAM_NAME    "detab"
-#define PROGRAM_VERSION "3.3.3"
-#define PROGRAM_DATE    "2022-10-19"
+#define PROGRAM_VERSION "3.5.2"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -79,6 +93,7 @@
 /* SysToolsLib include files */
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
+#include "parfilter.h"	/* SysLib parallel file filtering routines */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 DEBUG_GLOBALS		/* Define global variables used by our debugging macros */
@@ -144,6 +159,9 @@ void fail(char *pszFormat, ...) {
 int is_redirected(FILE *f);
 int IsSameFile(char *pszPathname1, char *pszPathname2);
 int file_exists(const char *); 	/* Does this file exist? (TRUE/FALSE) */
+long DetabChunk(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef);
+long DetabFile(FILE *sf, FILE *df, void *pRef);
+void ReportDetabbed(const char *pszPath, long lnChanges, int iErr, void *pRef);
 
 /* Global variables */
 int iVerbose = FALSE;
@@ -152,6 +170,7 @@ char usage[] =
 PROGRAM_NAME_AND_VERSION " - " PROGRAM_DESCRIPTION "\n\
 \n\
 Usage: detab [OPTIONS] [INFILE [OUTFILE|-= [N]]]\n\
+       detab [OPTIONS] -r DIRECTORY\n\
 \n\
 Options:\n\
   -a       Append a form feed and the output to the destination file\n\
@@ -162,9 +181,14 @@ Options:\n\
 #endif
 "\
   -=|-same Modify the input file in place. Default: Automatically detected\n\
+  -j N     Detab large files using N threads. Default: 1 per CPU. 1=Serial\n\
+           With -r, detab N files at a time\n\
+  -n NAME  With -r, detab only files matching this wildcard name. Repeatable\n\
+  -r DIR   Detab in place all files in this directory tree, then list totals\n\
   -st      Set the output file time to the same time as that of the input file\n\
   -t N     Number of columns between tab stops. Default: 8\n\
-  -v       Verbose mode\n\
+  -v       Verbose mode. With -r, list the files changed\n\
+  -x NAME  With -r, skip files and dirs matching this wildcard. Repeatable\n\
 \n\
 Arguments:\n\
   INFILE   Input file pathname. Default or \"-\": stdin\n\
@@ -179,8 +203,7 @@ Sources and updates: https://github.com/JFLarvoire/SysToolsLib\n"
 ;
 
 int main(int argc, char *argv[]) {
-  int col=1, n=8;
-  int c;
+  int n=8;
   char *mode = "w";		/* Destination file access mode */
   FILE *sf = NULL;		/* Source file handle */
   FILE *df = NULL;		/* Destination file handle */
@@ -197,6 +220,14 @@ int main(int argc, char *argv[]) {
   char *pszPathCopy = NULL;
   char *pszDirName = NULL;	/* Output file directory */
   int iErr;
+  int nThreads = 0;		/* Number of threads. 0 = Automatic */
+  int iParallel;		/* TRUE if filtering in parallel chunks */
+  pf_opts opts = {0};		/* Filtering options */
+  char *pszDir = NULL;		/* Directory tree to detab in place */
+  char **ppszInclude;		/* Name patterns of the files to detab there */
+  char **ppszExclude;		/* Name patterns of the files or dirs to skip */
+  int nInclude = 0;
+  int nExclude = 0;
 
   /* Open a new message file stream for debug and verbose messages */
   if (is_redirected(stdout)) {	/* If stdout is redirected to a file or a pipe */
@@ -215,6 +246,10 @@ int main(int argc, char *argv[]) {
 
   /* Process arguments */
 
+  ppszInclude = calloc(argc, sizeof(char *));
+  ppszExclude = calloc(argc, sizeof(char *));
+  if ((!ppszInclude) || (!ppszExclude)) goto fail_no_mem;
+
   for (i=1; i<argc; i++) {
     char *pszArg = argv[i];
     if (IsSwitch(pszArg)) {		/* It's a switch */
@@ -248,6 +283,15 @@ int main(int argc, char *argv[]) {
 	iSameFile = TRUE;
 	continue;
       }
+      if (streq(pszOpt, "n")) {	/* Name pattern to include */
+	if ((i+1) < argc) ppszInclude[nInclude++] = argv[++i];
+	continue;
+      }
+      if (streq(pszOpt, "r")) {	/* Recursive batch mode */
+	if ((i+1) >= argc) fail("Option -r needs a directory name");
+	pszDir = argv[++i];
+	continue;
+      }
       if (strieq(pszOpt, "st")) {	/* Same Time */
 	iCopyTime = TRUE;
 	continue;
@@ -256,6 +300,10 @@ int main(int argc, char *argv[]) {
       	if ((i+1) < argc) n = atoi(argv[++i]);
 	continue;
       }
+      if (streq(pszOpt, "j")) {	/* Number of threads */
+	if ((i+1) < argc) nThreads = atoi(argv[++i]);
+	continue;
+      }
       if (streq(pszOpt, "v")) {
 	iVerbose = TRUE;
 	continue;
@@ -264,6 +312,10 @@ int main(int argc, char *argv[]) {
 	puts(DETAILED_VERSION);
 	exit(0);
       }
+      if (streq(pszOpt, "x")) {	/* Name pattern to exclude */
+	if ((i+1) < argc) ppszExclude[nExclude++] = argv[++i];
+	continue;
+      }
       fprintf(stderr, "Invalid switch %s\x07\n", pszArg);
       continue;
     }
@@ -284,6 +336,23 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  if (pszDir) {			/* Detab all matching files in a directory tree */
+    fdt_opts fdtOpts = {0};
+    if (pszInName) fail("Option -r cannot be used with file names");
+    fdtOpts.iFlags = (iBackup ? FF_BACKUP : 0) | (iCopyTime ? FF_SAMETIME : 0);
+    fdtOpts.nThreads = nThreads;
+    if (nInclude) fdtOpts.ppszInclude = ppszInclude;
+    if (nExclude) fdtOpts.ppszExclude = ppszExclude;
+    fdtOpts.pFilterCB = DetabFile;
+    fdtOpts.pReportCB = ReportDetabbed;
+    fdtOpts.pRef = &n;
+    iErr = FilterDirTree(pszDir, &fdtOpts);
+    if (iErr == -1) return 2;	/* The error has already been reported */
+    fprintf(mf, "%ld files scanned, %ld files changed, %ld tabs removed\n",
+	    fdtOpts.nFiles, fdtOpts.nChanged, fdtOpts.lnChanges);
+    return iErr ? 2 : 0;
+  }
+
   /* Force stdin and stdout to untranslated */
 #if defined(_MSDOS) || defined(_WIN32)
   _setmode( _fileno( stdin ), _O_BINARY );
@@ -310,6 +379,22 @@ int main(int argc, char *argv[]) {
     iSameFile = IsSameFile(pszInName, pszOutName);
     if (iBackup && !file_exists(pszOutName)) iBackup = FALSE; /* There's nothing to backup */
   }
+  /* Detab large disk files in parallel chunks, else in large blocks */
+  opts.nThreads = nThreads;
+  opts.pSplitCB = PFSplitLines;	/* The column is reset at the beginning of lines */
+  opts.pProcessCB = DetabChunk;
+  opts.pRef = &n;
+  iParallel = UseParallelFilter(sf, nThreads);
+  if (iSameFile) { /* First check if anything changes, without writing anything */
+    iErr = iParallel ? ParallelFilter(sf, NULL, &opts) : StreamFilter(sf, NULL, &opts);
+    if (iErr) fail("Failed to detab %s. %s", pszInName, strerror(errno));
+    if (!opts.lnChanges) { /* Then leave the file untouched */
+      fclose(sf);
+      if (iVerbose) fprintf(mf, "// Detab: 0 tabs removed.\n");
+      return 0;
+    }
+    fseek(sf, 0, SEEK_SET);	/* It does change. Filter it again for good */
+  }
   if (iSameFile || iBackup) { /* Then write to a temporary file */
     int iFile;
     /* But do as if we were writing directly to the target file.
@@ -363,25 +448,13 @@ open_df_failed:
 
   if (mode[0] == 'a') fputs("\x0C", df); /* In append mode, add a form feed */
 
-  while ((c = fgetc(sf)) != EOF) {  	/*  c MUST be int!  */
-    switch (c) {
-    case '\t':
-      do {
-	fputc(' ', df);
-	col++;
-      } while (((col-1) % n) != 0);
-      /* Must subtr. 1 since col++ is done BEFORE this check.  */
-      lnChanges += 1;			/* Count the # of tabs converted */
-      break;
-    case '\n':
-      fputc('\n', df);
-      col = 1;
-      break;
-    default:
-      fputc(c, df);
-      col++;
-    }
+  if (iParallel) {
+    iErr = ParallelFilter(sf, df, &opts);
+  } else {
+    iErr = StreamFilter(sf, df, &opts);
   }
+  if (iErr) fail("Failed to detab %s. %s", pszInName ? pszInName : "stdin", strerror(errno));
+  lnChanges = opts.lnChanges;
 
   if (sf != stdin) fclose(sf);
   if (df != stdout) fclose(df);
@@ -447,6 +520,82 @@ fail_no_mem:
   return 1;
 }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    DetabChunk						      |
+|									      |
+|   Description:    Convert the tabs in a block of a file		      |
+|									      |
+|   Parameters:     const char *pBuf	    The block data		      |
+|		    size_t nBuf 	    Its size			      |
+|		    PFBUF *pOut 	    The output buffer		      |
+|		    void *pRef		    Pointer to the tab width	      |
+|									      |
+|   Returns:	    The number of tabs converted, or -1 if out of memory      |
+|									      |
+|   Notes:	    StreamFilter() and ParallelFilter() callback. May run in  |
+|		    worker threads.					      |
+|		    The block must begin at the beginning of a line.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Also used for serial conversions.			      |
+|    2026-10-18 JFL Use ExpandTabs().					      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long DetabChunk(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef) {
+  int iCol = 0;			/* The block begins at column 0 */
+  return ExpandTabs(pBuf, nBuf, pOut, *(int *)pRef, &iCol);
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    DetabFile						      |
+|									      |
+|   Description:    Convert the tabs in a whole file			      |
+|									      |
+|   Parameters:     FILE *sf		    The input file		      |
+|		    FILE *df		    The output file		      |
+|		    void *pRef		    Pointer to the tab width	      |
+|									      |
+|   Returns:	    The number of tabs converted, or -1 if failed	      |
+|									      |
+|   Notes:	    FilterDirTree() callback. May run in worker threads.      |
+|		    Files are converted in parallel, so each one is converted |
+|		    serially.						      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long DetabFile(FILE *sf, FILE *df, void *pRef) {
+  pf_opts opts = {0};
+  opts.pSplitCB = PFSplitLines;
+  opts.pProcessCB = DetabChunk;
+  opts.pRef = pRef;
+  if (StreamFilter(sf, df, &opts)) return -1;
+  return opts.lnChanges;
+}
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in callbacks */
+#endif
+
+/* FilterDirTree() callback reporting the files changed, and the errors */
+void ReportDetabbed(const char *pszPath, long lnChanges, int iErr, void *pRef) {
+  if (iErr) {
+    fprintf(stderr, "Error: Failed to detab %s. %s\n", pszPath, strerror(iErr));
+  } else if (iVerbose) {
+    fprintf(mf, "%s: %ld tabs removed\n", pszPath, lnChanges);
+  }
+}
+
+#ifdef _MSC_VER
+#pragma warning(default:4100)
+#endif
+
 /*---------------------------------------------------------------------------*\
 *                                                                             *
 |   Function:	    is_redirected					      |
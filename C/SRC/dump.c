@@ -41,6 +41,15 @@
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 1.3.2.		      *
 *    2023-04-19 JFL Moved GetScreenRows() & GetScreenCols() to SysLib.	      *
 *                   Renamed them as GetConRows() & GetConCols(). Ver. 1.3.3.  *
+*    2026-10-18 JFL Read disk files in large blocks, and format the rows with *
+*		    lookup tables into a buffer written in one call.	      *
+*		    Version 1.4.					      *
+*    2026-10-18 JFL Added option -j to format disk files in parallel in Unix. *
+*		    Version 1.5.					      *
+*    2026-10-18 JFL Use 64-bit offsets, to dump files larger than 4 GB.       *
+*		    Map disk files in memory in Unix. Version 1.6.	      *
+*    2026-10-18 JFL Added option -c to compare two files, and display only    *
+*		    the rows that differ. Version 1.7.			      *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -48,15 +57,18 @@
 
 #define PROGRAM_DESCRIPTION "Dump data as both hexadecimal and text"
 #define PROGRAM_NAME    "dump"
-#define PROGRAM_VERSION "1.3.3"
-#define PROGRAM_DATE    "2023-04-19"
+#define PROGRAM_VERSION "1.7"
+#define PROGRAM_DATE    "2026-10-18"
 
 #define _GNU_SOURCE		/* ISO C, POSIX, BSD, and GNU extensions */
+#define _LARGEFILE_SOURCE	/* Define fseeko() and ftello() */
+#define _FILE_OFFSET_BITS 64	/* Use 64-bit file offsets */
 #define _CRT_SECURE_NO_WARNINGS /* Avoid MSVC security warnings */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -78,6 +90,12 @@
 #define USE_TERMCAP 0 /* 1=Use termcap lib; 0=Don't */
 #endif
 
+#define HAS_PARALLEL 1	/* Use pthreads for formatting large files in parallel */
+#define HAS_MMAP 1	/* Map disk files in memory */
+
+#include <pthread.h>
+#include <sys/mman.h>
+
 #endif
 
 /************************* OS/2-specific definitions *************************/
@@ -97,6 +115,8 @@
 #include <conio.h>
 #include <io.h>
 
+#define fseeko fseek	/* Files are smaller than 2 GB */
+
 #endif
 
 /************************ Win32-specific definitions *************************/
@@ -124,6 +144,8 @@
 #include <conio.h>
 #include <io.h>
 
+#define fseeko fseek	/* Files are smaller than 2 GB */
+
 #endif
 
 /******************************* Any other OS ********************************/
@@ -142,17 +164,50 @@
 typedef unsigned char BYTE;
 typedef unsigned short WORD;
 typedef unsigned long DWORD;
+#if defined(_MSDOS)
+typedef unsigned long QWORD;	/* 16-bit compilers have no 64-bit integers */
+#define QWORD_FORMAT "%lX"
+#define QWORD_DECIMAL "%lu"
+#else
+typedef unsigned long long QWORD; /* File offsets */
+#define QWORD_FORMAT "%llX"
+#define QWORD_DECIMAL "%llu"
+#endif
+
+#define BLOCK_SIZE 0x10000	/* Size of the blocks read from disk files. Multiple of 16 */
+#define ROW_SIZE 96		/* Maximum size of a formatted row, including the \n */
+#define NO_OFFSET ((QWORD)-1)	/* Offset or length not specified */
+#define CONTEXT_ROWS 1		/* Identical rows displayed around those that differ */
+
+typedef struct {		/* A part of a disk file mapped in memory */
+  void *pBase;			/* Base address of the mapping */
+  size_t lBase;			/* Its size */
+  BYTE *pData;			/* Address of the first row. NULL=Not mapped */
+  size_t nData;			/* Number of bytes available from there */
+} dumpMap;
 
 /* Global variables */
 
 int paginate = FALSE;
+char cHex[256][2];		/* Hexadecimal pair for every byte value */
+char cChar[256];		/* Character displayed for every byte value */
 
 /* Forward references */
 
 void usage(void);
-int between(DWORD floor, DWORD u, DWORD ceiling);
+int between(QWORD floor, QWORD u, QWORD ceiling);
 void printflf(void);
 int is_redirected(FILE *f);
+void InitTables(void);
+size_t FormatRow(char *pOut, QWORD ul, BYTE *pRow, size_t nRow, QWORD qwBase, QWORD qwEnd);
+QWORD DumpSize(FILE *f, QWORD qwFirst, QWORD qwEnd);
+int DumpDiff(FILE *f1, FILE *f2, QWORD qwBase, QWORD qwEnd);
+#if HAS_MMAP
+int MapFile(FILE *f, QWORD qwFirst, QWORD qwEnd, dumpMap *pMap);
+#endif
+#if HAS_PARALLEL
+int DumpParallel(FILE *f, dumpMap *pMap, QWORD qwBase, QWORD qwEnd, int nThreads);
+#endif
 
 /*---------------------------------------------------------------------------*\
 *                                                                             *
@@ -174,14 +229,25 @@ int is_redirected(FILE *f);
 int main(int argc, char *argv[])
     {
     int i;
-    DWORD dwBase = 0xFFFFFFFFL;     /* First address to dump */
-    DWORD dwLength = 0xFFFFFFFFL;   /* Number of bytes to dump */
-    BYTE table[16];		    /* 16 bytes table */
-    DWORD ul;
-    WORD u;
+    QWORD qwBase = NO_OFFSET;	    /* First address to dump */
+    QWORD qwLength = NO_OFFSET;	    /* Number of bytes to dump */
+    QWORD qwEnd;		    /* End of the range to dump */
+    QWORD qwFirst;		    /* Offset of the first row */
+    BYTE *pBuf;			    /* Input buffer */
+    BYTE *pData;		    /* Input data */
+    char *pOut;			    /* Output buffer */
+    size_t lBlock = 16;		    /* Input block size */
+    dumpMap map = {0};		    /* Input file mapping */
+    QWORD ul;
     char *pszName = NULL;	    /* File name */
+    char *pszName2 = NULL;	    /* Name of the file to compare with */
     FILE *f;
+    FILE *f2 = NULL;
+    int iCompare = FALSE;	/* If true, compare two files */
     int iCtrlZ = FALSE;		/* If true, stop input on a Ctrl-Z */
+    struct stat st;
+    int nThreads = 1;		/* Number of formatting threads */
+    int iDone = FALSE;		/* TRUE if the dump is done already */
 
 #ifndef _UNIX
     /* Force stdin and stdout to untranslated */
@@ -200,6 +266,10 @@ int main(int argc, char *argv[])
                 {
 		usage();
                 }
+	    if (streq(pszOpt, "c")) {		/* -c: Compare two files */
+		iCompare = TRUE;
+		continue;
+	    }
 	    if (streq(pszOpt, "p"))
                 {
 		paginate = GetConRows() - 1;	/* Pause once per screen */
@@ -213,6 +283,12 @@ int main(int argc, char *argv[])
 		iCtrlZ = TRUE;
 		continue;
 	    }
+#if HAS_PARALLEL
+	    if (streq(pszOpt, "j") && ((i+1) < argc)) { /* -j N: Use N threads */
+		nThreads = atoi(argv[++i]);
+		continue;
+	    }
+#endif
 	    printf("Unrecognized switch %s. Ignored.\n", argv[i]);
             continue;
 	    }
@@ -221,14 +297,19 @@ int main(int argc, char *argv[])
 	    pszName = pszArg;
 	    continue;
 	    }
-	if (dwBase == 0xFFFFFFFFL)
+	if (iCompare && !pszName2)
+	    {
+	    pszName2 = pszArg;
+	    continue;
+	    }
+	if (qwBase == NO_OFFSET)
             {
-	    if (sscanf(pszArg, "%lX", &ul)) dwBase = ul;
+	    if (sscanf(pszArg, QWORD_FORMAT, &ul)) qwBase = ul;
             continue;
             }
-	if (dwLength == 0xFFFFFFFFL)
+	if (qwLength == NO_OFFSET)
             {
-	    if (sscanf(pszArg, "%lX", &ul)) dwLength = ul;
+	    if (sscanf(pszArg, QWORD_FORMAT, &ul)) qwLength = ul;
             continue;
             }
         printf("Unexpected argument: %s\nIgnored.\n", pszArg);
@@ -250,86 +331,103 @@ int main(int argc, char *argv[])
         f = stdin;
         paginate = FALSE;  /* Avoid waiting forever */
         }
+    if (iCompare)
+	{
+	if (!pszName2) usage();
+        f2 = fopen(pszName2, "rb");
+        if (!f2)
+            {
+            printf("Cannot open file %s.\n", pszName2);
+            exit(1);
+            }
+	}
 
     printf("\n\
 Offset    00           04           08           0C           0   4    8   C   \n\
 --------  -----------  -----------  -----------  -----------  -------- --------\n\
 ");
 
-    if (dwBase == 0xFFFFFFFFL) dwBase = 0;
-    fseek(f, dwBase & 0xFFFFFFF0L, SEEK_SET);
+    if (qwBase == NO_OFFSET) qwBase = 0;
+    qwEnd = (qwLength == NO_OFFSET) ? NO_OFFSET : qwBase + qwLength; /* Default: Up to the end of file */
+    qwFirst = qwBase & ~(QWORD)0xF;
 
-    for (ul = dwBase & 0xFFFFFFF0L;
-	 between(dwBase & 0xFFFFFFF0L, ul, dwBase+dwLength);
-         ul += 16)
+    if (f2)	/* Display only the differences between the two files */
 	{
-	size_t nRead;
+	InitTables();
+	return DumpDiff(f, f2, qwBase, qwEnd);
+	}
+
+    /* Disk files are read in large blocks. Pipes and consoles 16 bytes at a
+       time, to display the data as soon as it's available. */
+    if ((!iCtrlZ) && (!fstat(fileno(f), &st)) && S_ISREG(st.st_mode)) lBlock = BLOCK_SIZE;
+#if HAS_MMAP
+    /* Disk files are accessed directly in memory if possible, else after
+       seeking to the first row */
+    if (lBlock == BLOCK_SIZE) MapFile(f, qwFirst, qwEnd, &map);
+#endif
+    if ((lBlock == BLOCK_SIZE) && !DumpSize(f, qwFirst, qwEnd)) iDone = TRUE; /* Nothing to dump */
+    if (!map.pData) fseeko(f, (off_t)qwFirst, SEEK_SET);
+    InitTables();
+    pBuf = (BYTE *)malloc(lBlock);
+    pOut = (char *)malloc((lBlock / 16) * ROW_SIZE);
+    if (!pBuf || !pOut)
+	{
+	printf("Out of memory.\n");
+	exit(1);
+	}
+
+#if HAS_PARALLEL
+    /* Large disk files are formatted in parallel chunks, written in order */
+    if ((nThreads > 1) && (lBlock == BLOCK_SIZE) && !paginate)
+	iDone = !DumpParallel(f, &map, qwBase, qwEnd, nThreads);
+#endif
 
-	if (!iCtrlZ) {
-	    nRead = fread(table, 1, 16, f);
+    for (ul = qwFirst; (!iDone) && between(qwFirst, ul, qwEnd); )
+	{
+	size_t nRead;
+	size_t nOut = 0;
+	size_t n;
+
+	pData = pBuf;
+	if (map.pData) {
+	    size_t nDone = (size_t)(ul - qwFirst);
+	    pData = map.pData + nDone;
+	    nRead = (nDone < map.nData) ? map.nData - nDone : 0;
+	    if (nRead > lBlock) nRead = lBlock;
+	} else if (!iCtrlZ) {
+	    nRead = fread(pBuf, 1, lBlock, f);
 	} else { /* Read characters 1 by 1, to avoid blocking if the EOF character is not on a 16-bytes boundary */
 	    for (nRead = 0; nRead < 16; nRead++) {
 	        char c;
 	        if (!fread(&c, 1, 1, f)) break;
 	        if (c == '\x1A') break; /* We got a SUB <==> EOF character */
-	        table[nRead] = c;
+	        pBuf[nRead] = c;
 	    }
 	}
 	if (!nRead) break;
 
-	printf("%08lX ", ul);
-
-	/* Display the hex dump */
-
-	for (u=0; u<nRead; u++)
-            {
-	    if (!(u&3)) printf(" ");
-	    if (between(dwBase, ul+u, dwBase+dwLength))
-		printf("%02X ", (WORD)table[u]);
-            else
-		printf("   ");
-            }
-	for ( ; u<16; u++)
-	    {
-	    if (!(u&3)) printf(" ");
-	    printf("   ");
-	    }
-
-	/* Display the character dump */
-
-	for (u=0; u<nRead; u++)
+	for (n = 0; (n < nRead) && between(qwFirst, ul, qwEnd); n += 16, ul += 16)
 	    {
-	    if (!(u&7)) printf(" ");
-#ifdef _UNIX
-	    if ( (table[u] & 0x7F) < 0x20) table[u] = ' ';
-#else
-	    switch (table[u])
+	    size_t nRow = FormatRow(pOut + nOut, ul, pData + n, (nRead - n < 16) ? nRead - n : 16, qwBase, qwEnd);
+	    if (paginate)	/* Output rows one by one, pausing when needed */
 		{
-		case '\x07': table[u] = ' '; break;
-		case '\x08': table[u] = ' '; break; /* Backspace	*/
-		case '\x09': table[u] = ' '; break; /* Tab		*/
-		case '\x0A': table[u] = ' '; break; /* Line feed	*/
-		case '\x0D': table[u] = ' '; break; /* Carrier return	*/
-		case '\x1A': table[u] = ' '; break; 
-		default: break;
+		fwrite(pOut, 1, nRow, stdout);
+		printflf();
+		continue;
 		}
-#endif
-	    if (between(dwBase, ul+u, dwBase+dwLength) && (table[u]>' '))
-		printf("%c", table[u]);
-            else
-		printf(" ");
-            }
-	for ( ; u<16; u++)
-	    {
-	    if (!(u&7)) printf(" ");
-	    printf(" ");
+	    pOut[nOut + nRow++] = '\n';
+	    nOut += nRow;
 	    }
-
-	printflf();
+	fwrite(pOut, 1, nOut, stdout);
+	if (lBlock == 16) fflush(stdout); /* Display it before waiting for more input */
 
 	if (iCtrlZ && (nRead < 16)) break;
 	}
 
+#if HAS_MMAP
+    if (map.pBase) munmap(map.pBase, map.lBase);
+#endif
+
 #ifdef _UNIX
     printflf();
 #endif
@@ -359,10 +457,21 @@ void usage(void)
 PROGRAM_NAME_AND_VERSION " - " PROGRAM_DESCRIPTION "\n\
 \n\
 Usage: dump [switches] [filename] [address] [length]\n\
+       dump -c [switches] {filename} {filename2} [address] [length]\n\
 \n\
 Switches:\n\
 \n\
   -?|-h   Display this help screen\n\
+  -c      Compare two files. Display only the rows that differ, with one row\n\
+          of context. The rows of the second file have no offset.\n\
+          Exit code: 0=Identical, 1=Different\n\
+"
+#if HAS_PARALLEL
+"\
+  -j N    Format disk files using N threads. Default: 1\n\
+"
+#endif
+"\
   -p	  Pause for each screen-full of information.\n\
   -z      Stop input on a Ctrl-Z (aka. SUB or EOF) character\n\
 "
@@ -371,7 +480,7 @@ Switches:\n\
     exit(1);
     }
 
-int between(DWORD floor, DWORD u, DWORD ceiling)
+int between(QWORD floor, QWORD u, QWORD ceiling)
     {
     if (ceiling >= floor)
         return (u >= floor) && (u < ceiling);       /* TRUE if inside */
@@ -379,6 +488,108 @@ int between(DWORD floor, DWORD u, DWORD ceiling)
         return !((u < floor) && (u >= ceiling));    /* TRUE if outside */
     }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    InitTables						      |
+|									      |
+|   Description:    Initialize the byte formatting lookup tables	      |
+|									      |
+|   Parameters:     None						      |
+|									      |
+|   Returns:	    Nothing						      |
+|									      |
+|   Notes:	    Unix displays all control characters, including those in  |
+|		    the 0x80-0x9F range, as spaces. DOS and Windows display   |
+|		    all characters above the space, as the console shows them.|
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+void InitTables(void) {
+  static const char szDigits[] = "0123456789ABCDEF";
+  int i;
+
+  for (i=0; i<256; i++) {
+    cHex[i][0] = szDigits[i >> 4];
+    cHex[i][1] = szDigits[i & 0xF];
+#ifdef _UNIX
+    if ((i & 0x7F) < 0x20) {
+      cChar[i] = ' ';
+      continue;
+    }
+#endif
+    cChar[i] = (char)((i > ' ') ? i : ' ');
+  }
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    FormatRow						      |
+|									      |
+|   Description:    Format one row of the dump				      |
+|									      |
+|   Parameters:     char *pOut		Output buffer, >= ROW_SIZE bytes      |
+|		    QWORD ul		Offset of the row		      |
+|		    BYTE *pRow		The row data			      |
+|		    size_t nRow		Its size. 1 to 16		      |
+|		    QWORD qwBase	First offset to display		      |
+|		    QWORD qwEnd		End of the range to display	      |
+|									      |
+|   Returns:	    The size of the row, without the final \n		      |
+|									      |
+|   Notes:	    Bytes outside of the [qwBase, qwEnd[ range are displayed  |
+|		    as blanks. Complete rows within that range, which are the |
+|		    vast majority, only use the lookup tables.		      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+size_t FormatRow(char *pOut, QWORD ul, BYTE *pRow, size_t nRow, QWORD qwBase, QWORD qwEnd) {
+  static const char szDigits[] = "0123456789ABCDEF";
+  char *pc = pOut;
+  int nDigits = 8;
+  int iFull;
+  QWORD qw;
+  size_t u;
+
+  /* The offset, with at least 8 digits like "%08lX " */
+  for (qw = ul >> 16 >> 16; qw; qw >>= 4) nDigits += 1; /* Avoid shifting 32-bit QWORDs in MS-DOS by 32 */
+  for (qw = ul, u = nDigits; u--; qw >>= 4) pc[u] = szDigits[qw & 0xF];
+  pc += nDigits;
+  *(pc++) = ' ';
+
+  iFull = (nRow == 16) && (qwEnd >= qwBase) && (ul >= qwBase) && ((qwEnd - ul) >= 16);
+
+  /* The hex dump */
+  for (u=0; u<16; u++) {
+    if (!(u&3)) *(pc++) = ' ';
+    if (iFull || ((u < nRow) && between(qwBase, ul+u, qwEnd))) {
+      *(pc++) = cHex[pRow[u]][0];
+      *(pc++) = cHex[pRow[u]][1];
+    } else {
+      *(pc++) = ' ';
+      *(pc++) = ' ';
+    }
+    *(pc++) = ' ';
+  }
+
+  /* The character dump */
+  for (u=0; u<16; u++) {
+    if (!(u&7)) *(pc++) = ' ';
+    if (iFull || ((u < nRow) && between(qwBase, ul+u, qwEnd))) {
+      *(pc++) = cChar[pRow[u]];
+    } else {
+      *(pc++) = ' ';
+    }
+  }
+
+  return (size_t)(pc - pOut);
+}
+
 /*---------------------------------------------------------------------------*\
 *                                                                             *
 |   Function:	    printflf						      |
@@ -452,3 +663,392 @@ int is_redirected(FILE *f) {
 	 );
 }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    DumpSize						      |
+|									      |
+|   Description:    Get the number of bytes to read in a disk file	      |
+|									      |
+|   Parameters:     FILE *f		The input file			      |
+|		    QWORD qwFirst	Offset of the first row		      |
+|		    QWORD qwEnd		End of the range to display	      |
+|									      |
+|   Returns:	    The number of bytes from qwFirst to the end of the last   |
+|		    row, or to the end of the file if it's shorter.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+QWORD DumpSize(FILE *f, QWORD qwFirst, QWORD qwEnd) {
+  struct stat st;
+  QWORD qwSize;
+
+  if (fstat(fileno(f), &st)) return 0;
+  qwSize = ((QWORD)st.st_size > qwFirst) ? (QWORD)st.st_size - qwFirst : 0;
+  /* The last row begins before qwEnd. If the range wraps around, the rows
+     are displayed up to the end of file. */
+  if ((qwEnd >= qwFirst) && ((qwEnd - qwFirst) < qwSize)) {
+    QWORD qwRows = ((qwEnd - qwFirst) + 15) & ~(QWORD)0xF;
+    if (qwRows < qwSize) qwSize = qwRows;
+  }
+  return qwSize;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    MapFile						      |
+|									      |
+|   Description:    Map the part of a disk file to dump in memory	      |
+|									      |
+|   Parameters:     FILE *f		The input file			      |
+|		    QWORD qwFirst	Offset of the first row		      |
+|		    QWORD qwEnd		End of the range to display	      |
+|		    dumpMap *pMap	[OUT] The mapping		      |
+|									      |
+|   Returns:	    0=Success, -1=Failure. The file must be read.	      |
+|									      |
+|   Notes:	    Only the pages containing the range are mapped. So	      |
+|		    dumping a few rows deep into a huge disk image only       |
+|		    reads these rows.					      |
+|		    							      |
+|		    If the range does not fit in the address space, like in   |
+|		    32-bit systems, the file is read after seeking to the     |
+|		    first row instead.					      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#if HAS_MMAP
+
+int MapFile(FILE *f, QWORD qwFirst, QWORD qwEnd, dumpMap *pMap) {
+  QWORD qwSize = DumpSize(f, qwFirst, qwEnd);
+  QWORD qwPage = qwFirst & ~(QWORD)(sysconf(_SC_PAGESIZE) - 1);
+  QWORD qwMap = qwSize + (qwFirst - qwPage);
+  void *pBase;
+
+  if ((!qwSize) || (qwMap != (QWORD)(size_t)qwMap)) return -1;
+  pBase = mmap(NULL, (size_t)qwMap, PROT_READ, MAP_SHARED, fileno(f), (off_t)qwPage);
+  if (pBase == MAP_FAILED) return -1;
+  madvise(pBase, (size_t)qwMap, MADV_SEQUENTIAL);
+
+  pMap->pBase = pBase;
+  pMap->lBase = (size_t)qwMap;
+  pMap->pData = (BYTE *)pBase + (size_t)(qwFirst - qwPage);
+  pMap->nData = (size_t)qwSize;
+  return 0;
+}
+
+#endif /* HAS_MMAP */
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    DumpDiff						      |
+|									      |
+|   Description:    Display the rows that differ between two files	      |
+|									      |
+|   Parameters:     FILE *f1		The first file			      |
+|		    FILE *f2		The second file			      |
+|		    QWORD qwBase	First offset to compare		      |
+|		    QWORD qwEnd		End of the range to compare	      |
+|									      |
+|   Returns:	    0=Identical, 1=Different				      |
+|									      |
+|   Notes:	    Both files are read in large blocks, and identical blocks |
+|		    are skipped with a single memcmp(), which the C library   |
+|		    implements with vector instructions.		      |
+|		    							      |
+|		    Each row that differs is displayed for the first file,    |
+|		    then for the second file without the offset. Identical    |
+|		    rows just before and after are displayed once. Groups of  |
+|		    rows are separated by blank lines.			      |
+|		    							      |
+|		    Bytes beyond the end of the shortest file differ.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+static size_t RowSize(size_t nBuf, size_t n) {	/* Size of the row at n */
+  if (n >= nBuf) return 0;
+  return ((nBuf - n) < 16) ? nBuf - n : 16;
+}
+
+static void PrintRow(QWORD ul, BYTE *pRow, size_t nRow, QWORD qwBase, QWORD qwEnd, int iOffset) {
+  char szRow[ROW_SIZE];
+  size_t n = FormatRow(szRow, ul, pRow, nRow, qwBase, qwEnd);
+  if (!iOffset) memset(szRow, ' ', (char *)memchr(szRow, ' ', n) - szRow);
+  fwrite(szRow, 1, n, stdout);
+  printflf();
+}
+
+int DumpDiff(FILE *f1, FILE *f2, QWORD qwBase, QWORD qwEnd) {
+  QWORD qwFirst = qwBase & ~(QWORD)0xF;
+  QWORD ul = qwFirst;
+  QWORD qwDiff = 0;		/* Offset of the first difference */
+  QWORD qwnDiffs = 0;		/* Number of bytes that differ */
+  QWORD ulNext = 0;		/* Offset following the last row displayed */
+  QWORD ulPrev = 0;		/* Offset of the last row not displayed */
+  BYTE prev[16];		/* That row */
+  size_t nPrev = 0;		/* Its size. 0=None */
+  int nAfter = 0;		/* Number of context rows still to display */
+  int iShown = FALSE;		/* TRUE if any row has been displayed */
+  BYTE *pBuf1 = malloc(BLOCK_SIZE);
+  BYTE *pBuf2 = malloc(BLOCK_SIZE);
+
+  if (!pBuf1 || !pBuf2) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+  fseeko(f1, (off_t)qwFirst, SEEK_SET);
+  fseeko(f2, (off_t)qwFirst, SEEK_SET);
+
+  while (between(qwFirst, ul, qwEnd)) {
+    size_t n1 = fread(pBuf1, 1, BLOCK_SIZE, f1);
+    size_t n2 = fread(pBuf2, 1, BLOCK_SIZE, f2);
+    size_t n, nRead = (n1 > n2) ? n1 : n2;
+    if (!nRead) break;
+
+    if ((n1 == BLOCK_SIZE) && (n2 == BLOCK_SIZE) && (!nAfter) && !memcmp(pBuf1, pBuf2, BLOCK_SIZE)) {
+      ulPrev = ul + BLOCK_SIZE - 16; /* Identical blocks. Just remember the last row */
+      memcpy(prev, pBuf1 + BLOCK_SIZE - 16, 16);
+      nPrev = 16;
+      ul += BLOCK_SIZE;
+      continue;
+    }
+
+    for (n = 0; (n < nRead) && between(qwFirst, ul, qwEnd); n += 16, ul += 16) {
+      size_t nRow1 = RowSize(n1, n);
+      size_t nRow2 = RowSize(n2, n);
+      int nRowDiffs = 0;
+      size_t u;
+
+      if ((nRow1 != nRow2) || memcmp(pBuf1 + n, pBuf2 + n, nRow1)) {
+	for (u=0; u<16; u++) {
+	  if (!between(qwBase, ul+u, qwEnd)) continue;
+	  if (((u < nRow1) != (u < nRow2)) || ((u < nRow1) && (pBuf1[n+u] != pBuf2[n+u]))) {
+	    if (!qwnDiffs) qwDiff = ul + u;
+	    qwnDiffs += 1;
+	    nRowDiffs += 1;
+	  }
+	}
+      }
+
+      if (nRowDiffs) {
+	int iPrev = nPrev && ((ulPrev + 16) == ul) && ((!iShown) || (ulPrev >= ulNext));
+	if (iShown && ((iPrev ? ulPrev : ul) != ulNext)) printflf(); /* Separate groups of rows */
+	if (iPrev) PrintRow(ulPrev, prev, nPrev, qwBase, qwEnd, TRUE);
+	PrintRow(ul, pBuf1 + n, nRow1, qwBase, qwEnd, TRUE);
+	PrintRow(ul, pBuf2 + n, nRow2, qwBase, qwEnd, FALSE);
+	ulNext = ul + 16;
+	nAfter = CONTEXT_ROWS;
+	iShown = TRUE;
+      } else if (nAfter) {
+	PrintRow(ul, pBuf1 + n, nRow1, qwBase, qwEnd, TRUE);
+	ulNext = ul + 16;
+	nAfter -= 1;
+      } else {
+	ulPrev = ul;
+	memcpy(prev, pBuf1 + n, nRow1);
+	nPrev = nRow1;
+      }
+    }
+  }
+  free(pBuf1);
+  free(pBuf2);
+
+  if (iShown) printflf();
+  if (qwnDiffs) {
+    printf("First difference at offset " QWORD_FORMAT ". " QWORD_DECIMAL " %s.",
+	   qwDiff, qwnDiffs, (qwnDiffs == 1) ? "byte differs" : "bytes differ");
+  } else {
+    printf("No difference.");
+  }
+  printflf();
+  return qwnDiffs ? 1 : 0;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    DumpParallel					      |
+|									      |
+|   Description:    Dump a disk file using parallel threads		      |
+|									      |
+|   Parameters:     FILE *f		The input file			      |
+|		    dumpMap *pMap	The file mapping, if pMap->pData set  |
+|		    QWORD qwBase	First offset to display		      |
+|		    QWORD qwEnd		End of the range to display	      |
+|		    int nThreads	Number of threads		      |
+|									      |
+|   Returns:	    0=Done, -1=No thread could be created. Dump serially.     |
+|									      |
+|   Notes:	    The rows to dump are split in chunks of CHUNK_SIZE bytes. |
+|		    Each thread formats a chunk from the file mapping, or     |
+|		    else reads it with pread(), into its own slot. The main   |
+|		    thread writes the slots in the chunks order. So the	      |
+|		    output is the same as that of the serial loop in main(),  |
+|		    rows at both ends included.				      |
+|		    							      |
+|		    There are twice as many slots as threads, so that the     |
+|		    threads can go on while the main thread writes.	      |
+|		    							      |
+|		    Like the serial loop, stop at the first read error.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Use the file mapping if available.			      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#if HAS_PARALLEL
+
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE 0x40000L	/* Data formatted by a thread at a time. Multiple of 16 */
+#endif
+#define MAX_THREADS 64
+
+/* Slot states */
+#define SLOT_FREE 0		/* Available for the next chunk */
+#define SLOT_BUSY 1		/* Being formatted */
+#define SLOT_DONE 2		/* Formatted. Waiting to be written */
+#define SLOT_FAILED 3		/* Read error */
+
+typedef struct {
+  char *pOut;			/* Formatted rows */
+  size_t nOut;			/* Their size */
+  int iState;			/* SLOT_xxx */
+} dumpSlot;
+
+typedef struct {		/* The state shared by all threads */
+  int fd;			/* The input file handle */
+  dumpMap *pMap;		/* The input file mapping */
+  QWORD qwFirst;		/* Offset of the first row */
+  QWORD qwBase;			/* First offset to display */
+  QWORD qwEnd;			/* End of the range to display */
+  pthread_mutex_t mutex;	/* Protects everything below */
+  pthread_cond_t cond;		/* Signaled when a slot is done or free */
+  dumpSlot *pSlots;
+  int nSlots;
+  unsigned long nChunks;	/* Number of chunks to format */
+  unsigned long ulTaken;	/* Number of chunks taken by the threads */
+  unsigned long ulWritten;	/* Number of chunks written */
+} dumpState;
+
+void *DumpWorker(void *pParam) {
+  dumpState *ps = pParam;
+  BYTE *pBuf = malloc(CHUNK_SIZE);
+
+  pthread_mutex_lock(&ps->mutex);
+  while (ps->ulTaken < ps->nChunks) {
+    unsigned long ulChunk;
+    dumpSlot *pSlot;
+    QWORD ul;
+    BYTE *pData = pBuf;
+    size_t n, nRead = 0;
+    int iState = SLOT_DONE;
+
+    if ((ps->ulTaken - ps->ulWritten) >= (unsigned long)ps->nSlots) { /* All slots in use */
+      pthread_cond_wait(&ps->cond, &ps->mutex);
+      continue;
+    }
+    ulChunk = ps->ulTaken++;
+    pSlot = ps->pSlots + (ulChunk % ps->nSlots);
+    pSlot->iState = SLOT_BUSY;
+    pthread_mutex_unlock(&ps->mutex);
+
+    ul = ps->qwFirst + ((QWORD)ulChunk * CHUNK_SIZE);
+    if (ps->pMap->pData) {
+      size_t nDone = (size_t)(ul - ps->qwFirst);
+      pData = ps->pMap->pData + nDone;
+      nRead = ps->pMap->nData - nDone;
+      if (nRead > CHUNK_SIZE) nRead = CHUNK_SIZE;
+    } else while (pBuf && (nRead < CHUNK_SIZE)) {
+      ssize_t iRead = pread(ps->fd, pBuf + nRead, CHUNK_SIZE - nRead, (off_t)(ul + nRead));
+      if (!iRead) break;	/* End of file */
+      if (iRead < 0) {
+	if (errno == EINTR) continue;
+	iState = SLOT_FAILED;
+	break;
+      }
+      nRead += (size_t)iRead;
+    }
+    if (!pData) iState = SLOT_FAILED;
+    pSlot->nOut = 0;
+    for (n = 0; (n < nRead) && between(ps->qwFirst, ul, ps->qwEnd); n += 16, ul += 16) {
+      size_t nRow = FormatRow(pSlot->pOut + pSlot->nOut, ul, pData + n,
+                              (nRead - n < 16) ? nRead - n : 16, ps->qwBase, ps->qwEnd);
+      pSlot->pOut[pSlot->nOut + nRow++] = '\n';
+      pSlot->nOut += nRow;
+    }
+
+    pthread_mutex_lock(&ps->mutex);
+    pSlot->iState = iState;
+    pthread_cond_broadcast(&ps->cond);
+  }
+  pthread_mutex_unlock(&ps->mutex);
+  free(pBuf);
+  return NULL;
+}
+
+int DumpParallel(FILE *f, dumpMap *pMap, QWORD qwBase, QWORD qwEnd, int nThreads) {
+  dumpState state = {0};
+  pthread_t hThreads[MAX_THREADS];
+  QWORD qwSize;			/* Number of bytes to read */
+  int i;
+
+  state.fd = fileno(f);
+  state.pMap = pMap;
+  state.qwFirst = qwBase & ~(QWORD)0xF;
+  state.qwBase = qwBase;
+  state.qwEnd = qwEnd;
+  qwSize = DumpSize(f, state.qwFirst, qwEnd);
+  state.nChunks = (unsigned long)((qwSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+  if (nThreads > MAX_THREADS) nThreads = MAX_THREADS;
+  state.nSlots = 2 * nThreads;
+  state.pSlots = calloc(state.nSlots, sizeof(dumpSlot));
+  if (!state.pSlots) return -1;
+  for (i=0; i<state.nSlots; i++) {
+    state.pSlots[i].pOut = malloc((CHUNK_SIZE / 16) * ROW_SIZE);
+    if (!state.pSlots[i].pOut) break;
+  }
+  if (i < state.nSlots) nThreads = 0; /* Out of memory */
+  pthread_mutex_init(&state.mutex, NULL);
+  pthread_cond_init(&state.cond, NULL);
+
+  for (i=0; i<nThreads; i++) {
+    if (pthread_create(hThreads+i, NULL, DumpWorker, &state)) break;
+  }
+  nThreads = i;
+
+  /* Write the chunks in order, as soon as they're done */
+  pthread_mutex_lock(&state.mutex);
+  while (nThreads && (state.ulWritten < state.nChunks)) {
+    dumpSlot *pSlot = state.pSlots + (state.ulWritten % state.nSlots);
+    if ((state.ulWritten >= state.ulTaken) || (pSlot->iState == SLOT_BUSY)) {
+      pthread_cond_wait(&state.cond, &state.mutex);
+      continue;
+    }
+    pthread_mutex_unlock(&state.mutex);
+    if (pSlot->nOut) fwrite(pSlot->pOut, 1, pSlot->nOut, stdout);
+    pthread_mutex_lock(&state.mutex);
+    if (pSlot->iState == SLOT_FAILED) state.nChunks = state.ulWritten + 1; /* Stop there */
+    pSlot->iState = SLOT_FREE;
+    state.ulWritten += 1;
+    pthread_cond_broadcast(&state.cond);
+  }
+  pthread_mutex_unlock(&state.mutex);
+
+  for (i=0; i<nThreads; i++) pthread_join(hThreads[i], NULL);
+  for (i=0; i<state.nSlots; i++) free(state.pSlots[i].pOut);
+  free(state.pSlots);
+  pthread_cond_destroy(&state.cond);
+  pthread_mutex_destroy(&state.mutex);
+  return nThreads ? 0 : -1;
+}
+
+#endif /* HAS_PARALLEL */
@@ -16,12 +16,6 @@
 *                                                                             *
 *                   To do:                                                    *
 *                   - Convert all file encodings to UTF8 data.		      *
-*                   - Use "natural" sort for keys, not ASCII sort.            *
-*                     (natural = consider numbers as 1-character values,      *
-*                      no matter how many actual characters are present.      *
-*                      Ex: "12" < "75" < "128" )                              *
-*                   - Add support for multiple homonym sections.              *
-*                     (Non-standard, but used in some real cases.)            *
 *                                                                             *
 *  History                                                                    *
 *    1993-09-28 JFL Created this program.                                     *
@@ -51,6 +45,23 @@
 *		    Version 2.1.                                              *
 *    2020-04-20 JFL Added support for MacOS. Version 2.2.                     *
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 2.2.1.		      *
+*    2026-10-18 JFL Index sections and items in arrays after reading them,    *
+*                   with names and values normalized once for comparisons.    *
+*                   This avoids 2 mallocs per item comparison, and tree       *
+*                   searches for every next item. Fixed a crash on items      *
+*                   without a value. Version 2.3.                             *
+*    2026-10-18 JFL Parse files mapped in memory, with names and values       *
+*                   referring to the file data, instead of reading lines      *
+*                   with fgets() and copying names and values with strdup().  *
+*                   Sort sections and items in arrays, instead of trees.      *
+*                   Merge homonym sections. Version 2.4.                      *
+*    2026-10-18 JFL Parse the two files in parallel threads on Unix.          *
+*                   Version 2.5.                                              *
+*    2026-10-18 JFL Added option -n for sorting names in the "natural" order, *
+*                   where numbers compare by value. Ex: "12" < "75" < "128".  *
+*                   Version 2.6.                                              *
+*    2026-10-18 JFL Fixed the differences not displayed when a file has no    *
+*                   items at all. Version 2.6.1.                              *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -58,8 +69,8 @@
 
 #define PROGRAM_DESCRIPTION "Compare .ini files, section by section, and item by item"
 #define PROGRAM_NAME    "inicomp"
-#define PROGRAM_VERSION "2.2.1"
-#define PROGRAM_DATE    "2022-10-19"
+#define PROGRAM_VERSION "2.6.1"
+#define PROGRAM_DATE    "2026-10-18"
 
 #define _CRT_SECURE_NO_WARNINGS /* Prevent warnings about using sprintf and sscanf */
 
@@ -71,16 +82,15 @@
 #include <string.h>
 #include <search.h>
 #include <ctype.h>
+#include <errno.h>
 /* SysToolsLib include files */
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
+#include "parfilter.h"	/* SysLib growable buffers */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 DEBUG_GLOBALS	/* Define global variables used by debugging macros. (Necessary for Unix builds) */
 
-#include "dict.h"
-DICT_DEFINE_PROCS();
-
 /************************* OS/2-specific definitions *************************/
 
 #ifdef _OS2   /* To be defined on the command line for the OS/2 version */
@@ -123,6 +133,15 @@ DICT_DEFINE_PROCS();
 
 #define stricmp strcasecmp
 
+#define HAS_MMAP 1	/* Map disk files in memory */
+#define HAS_PARALLEL 1	/* Use pthreads for parsing the two files in parallel */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
 #endif /* __unix__ */
 
 /******************************* Any other OS ********************************/
@@ -141,48 +160,79 @@ int verbose = FALSE;
 int compBlanks = FALSE;
 int ignoreCase = TRUE;
 int allowNoValue = FALSE;	  /* TRUE = Allow non-standard data lines with a free string, without an =value */
+int naturalSort = FALSE;	  /* TRUE = Sort names with numbers compared by value */
 
-/* Define multimap dictionaries */
-
-int cmpvalue(void *p1, void *p2) {
-  return strcmp(p1, p2);
-}
-int cmpivalue(void *p1, void *p2) {
-  return _stricmp(p1, p2);
-}
-
-dict_t *NewIniDict(void) { /* Duplicate keys not allowed */
-  if (ignoreCase)
-    return NewIDict();
-  else
-    return NewDict();
-}
+/* String arena, for the many small strings that are never freed */
 
-dict_t *NewIniMMap(void) { /* Duplicate keys allowed */
-  if (ignoreCase)
-    return NewIMMap(cmpivalue);
-  else
-    return NewMMap(cmpvalue);
-}
+#ifdef _MSDOS
+#define ARENA_BLOCK 0x2000U	/* Keep it well below the 64 KB segment size */
+#else
+#define ARENA_BLOCK 0x100000L	/* Default block size */
+#endif
 
-#define NewIniSectionDict() NewIniDict()  /* Duplicate keys not allowed */
-#define NewIniValueDict()   NewIniMMap()  /* Duplicate keys allowed */
+typedef struct {
+  char *pBuf;			/* Free space in the current block */
+  size_t nFree;			/* Its size */
+} arena_t;
+
+/* Names and values are slices of the file data, or of the arena for the
+   text rewritten while parsing, and for the normalized strings */
+
+typedef struct {
+  const char *pc;		/* Its first character. Not NUL-terminated */
+  size_t l;			/* Its length */
+} slice;
+
+typedef struct {
+  slice name;			/* Its name */
+  slice value;			/* Its value. value.pc is NULL if none */
+  slice nName;			/* Its name, in lower case if ignoreCase. Sort key if naturalSort */
+  slice nValue;			/* Its value, also without blanks unless compBlanks */
+  size_t iItem;			/* Index of the item in the file */
+} iniItem;
+
+typedef struct {
+  slice name;			/* Its name */
+  slice nName;			/* Its name, in lower case if ignoreCase. Sort key if naturalSort */
+  size_t iPart;			/* Index of the section part in the file */
+  size_t iItem;			/* Index of its first item in the file */
+  iniItem *pItems;		/* Its items, once sorted */
+  size_t nItems;		/* Number of items */
+} iniSection;
+
+typedef struct {
+  char *pszName;		/* The actual file name */
+  iniItem *pItems;		/* All items, in file order until sorted in each section */
+  size_t nItems;		/* Number of items */
+  size_t lItems;		/* Number of items allocated */
+  iniSection *pSections;	/* All sections, sorted by name */
+  size_t nSections;		/* Number of sections */
+  size_t lSections;		/* Number of sections allocated */
+  arena_t arena;		/* Storage for the rewritten and normalized strings */
+} iniFile;
 
 /* Function prototypes */
 
-char *processFile(char *argname, dict_t *sections);
-char *trimLeft(char *s);
-char *trimRight(char *s);
-int compItem(dictnode *i1, dictnode *i2);
-int compStringNB(const char *s1, const char *s2);
-int compString(const char *s1, const char *s2);
-int compare(char *name1, dict_t *tree1, char *name2, dict_t *tree2);
+const char *getLine(const char **ppc, const char *pEnd, size_t *pl, long *pNLines);
+char *loadFile(FILE *f, size_t *pSize);
+void processFile(char *argname, iniFile *pFile);
+#if HAS_PARALLEL
+void *processFileThread(void *pArg);
+#endif
+void newSection(iniFile *pFile, const char *pc, size_t l, int iCopy);
+void newItem(iniFile *pFile, const char *pName, size_t lName, const char *pValue, size_t lValue, int iCopy);
+void sortFile(iniFile *pFile);
+char *ArenaAlloc(arena_t *pArena, size_t n);
+slice normalize(arena_t *pArena, slice s, int iNoBlanks);
+slice normalizeName(arena_t *pArena, slice s);
+size_t naturalKey(const char *pc, size_t l, char *pKey);
+int compSlice(const slice *ps1, const slice *ps2, int iFold);
+int compItem(iniItem *i1, iniItem *i2);
+int compare(iniFile *pFile1, iniFile *pFile2);
 void newOutState(outstate *pold, outstate new, char *name1, char *name2);
-void *printSectCB(char *pszName, void *pValue, void *pRef);
-void *printSectNameCB(char *pszName, void *pValue, void *pRef);
-void printSectName(char *name);
-void *printItemCB(char *pszName, void *pValue, void *pRef);
-void *printItem(dictnode *pi);
+void printSectName(slice *pName);
+void printSection(iniSection *ps);
+void printItem(iniItem *pi);
 void outOfMem(void);
 void usage(void);
 
@@ -206,10 +256,8 @@ int main(int argc, char *argv[]) {
   int i;
   char *f1arg = NULL;         /* File 1 name provided */
   char *f2arg = NULL;         /* File 2 name provided */
-  char *name1;                /* File 1 name found */
-  char *name2;                /* File 2 name found */
-  dict_t *dict1;		/* File 1 sections dictionary */
-  dict_t *dict2;		/* File 2 sections dictionary */
+  iniFile file1 = {0};		/* File 1 name found, and its sections */
+  iniFile file2 = {0};		/* File 2 name found, and its sections */
 
   for (i=1; i<argc; i++) {
     char *arg = argv[i];
@@ -240,6 +288,14 @@ int main(int argc, char *argv[]) {
 	continue;
       }
       )
+      if (streq(opt, "n")) {
+	naturalSort = TRUE;
+	continue;
+      }
+      if (streq(opt, "N")) {
+	naturalSort = FALSE;
+	continue;
+      }
       if (streq(opt, "f")) {
 	allowNoValue = TRUE;
 	continue;
@@ -277,83 +333,159 @@ int main(int argc, char *argv[]) {
     usage();
   }
 
-  dict1 = NewIniSectionDict();	/* File 1 sections dictionary */
-  dict2 = NewIniSectionDict();	/* File 2 sections dictionary */
-
   /* Sort files */
 
-  name1 = processFile(f1arg, dict1);
-  name2 = processFile(f2arg, dict2);
+#if HAS_PARALLEL
+  /* The two files are independent until compared, each with its own arena.
+     But keep the verbose and debug output of each file in one piece. */
+  if (!verbose) {
+    pthread_t hThread;
+    file1.pszName = f1arg;
+    if (!pthread_create(&hThread, NULL, processFileThread, &file1)) {
+      processFile(f2arg, &file2);
+      pthread_join(hThread, NULL);
+    } else {
+      processFile(f1arg, &file1);
+      processFile(f2arg, &file2);
+    }
+  } else
+#endif
+  {
+    processFile(f1arg, &file1);
+    processFile(f2arg, &file2);
+  }
 
 DEBUG_CODE(
   /* Print all data gathered so far */
   printf("***************************************************************\n");
-  ForeachDictValue(dict1, printSectCB, NULL);
+  for (i = 0; i < (int)file1.nSections; i++) printSection(file1.pSections + i);
   printf("***************************************************************\n");
-  ForeachDictValue(dict2, printSectCB, NULL);
+  for (i = 0; i < (int)file2.nSections; i++) printSection(file2.pSections + i);
   printf("***************************************************************\n");
 )
 
   /* Display differences */
 
-  compare(name1, dict1, name2, dict2);
+  compare(&file1, &file2);
 
   return 0;
 }
 
 /*---------------------------------------------------------------------------*\
-|		    							      |
+|                                                                             |
 |  Function         getLine                                                   |
-|		    							      |
-|  Description      Read a line, growing the buffer, if needed to get it all  |
-|		    							      |
-|  Input            char **pBuf		Address of output buffer pointer      |
-|                   size_t *pBufSize	Address of output buffer size	      |
-|		    FILE *f		Input file handle		      |
-|		    size_t offset	Offset to write in the output buffer  |
-|		    long *pNLines	Address of optional line counter      |
-|		    							      |
-|  Output           Final address of the line read, or NULL if error.	      |
-|		    							      |
+|                                                                             |
+|  Description      Get the next line from the file data                      |
+|                                                                             |
+|  Input            const char **ppc [IN/OUT] The next line in the data       |
+|                   const char *pEnd The end of the data                      |
+|                   size_t *pl       [OUT] The line length, with its line end |
+|                   long *pNLines    Address of the line counter              |
+|                                                                             |
+|  Output           The address of the line, or NULL if no more lines.        |
+|                                                                             |
 |  History                                                                    |
 |    2017-01-06 JFL Initial implementation                                    |
-|		    							      |
+|    2026-10-18 JFL Get lines from the file data in memory. No more copies.   |
+|                                                                             |
 \*---------------------------------------------------------------------------*/
 
-/* Read a line, growing the buffer if needed to get the full line */
-char *getLine(char **pBuf, size_t *pBufSize, FILE *f, size_t offset, long *pNLines) {
-  char *line = *pBuf + offset;
-  size_t l;
-  long nl = 0;
-
-  if (!fgets(line, (int)(*pBufSize - offset), f)) return NULL;
-  l = strlen(line);
-  if (pNLines) {
-    nl = *pNLines += 1;
-    if ((verbose) && ((nl % 10000) == 0)) {
-      fprintf(stderr, "Line %ld: %s", nl, line);
-      if (l && (line[l-1] != '\n')) fprintf(stderr, "\n");
-    }
-  }
-  /* Check if the buffer is too small, and needs to be extended to get the full line */
-  while (((offset+l) == (*pBufSize-1)) && (line[l-1] != '\n')) {
-    DEBUG_PRINTF(("Line %ld overflowed. Expanding buffer to %ld bytes: %s\n", nl, (unsigned long)*pBufSize*2, line));
-    *pBuf = realloc(*pBuf, *pBufSize *= 2); /* Double its size, to avoid doing this too often */
-    if (!*pBuf) outOfMem();
-    line = *pBuf + offset;
-    if (!fgets(line+l, (int)(*pBufSize-(offset+l)), f)) break;
-    l += strlen(line+l);
+const char *getLine(const char **ppc, const char *pEnd, size_t *pl, long *pNLines) {
+  const char *line = *ppc;
+  const char *pc;
+  size_t l, i;
+  long nl;
+
+  if (line >= pEnd) return NULL;
+  pc = memchr(line, '\n', pEnd - line);
+  pc = pc ? pc + 1 : pEnd;
+  *pl = l = pc - line;
+  *ppc = pc;
+  nl = *pNLines += 1;
+  if ((verbose) && ((nl % 10000) == 0)) {
+    fprintf(stderr, "Line %ld: %.*s", nl, (int)l, line);
+    if (line[l-1] != '\n') fprintf(stderr, "\n");
   }
   /* When lines end with \r\r\n, most editors (but not Notepad) count that as extra lines */
-  if (pNLines) {
-    size_t i = 1;
-    if ((i <= l) && (line[l-i] == '\n')) i += 1; /* Skip the final \n */
-    if ((i <= l) && (line[l-i] == '\r')) i += 1; /* Skip the normal \r before that \n */
-    for ( ; (i <= l) && (line[l-i] == '\r'); i++) *pNLines += 1; /* If there are other \r, count extra lines */
-  }
+  i = 1;
+  if ((i <= l) && (line[l-i] == '\n')) i += 1; /* Skip the final \n */
+  if ((i <= l) && (line[l-i] == '\r')) i += 1; /* Skip the normal \r before that \n */
+  for ( ; (i <= l) && (line[l-i] == '\r'); i++) *pNLines += 1; /* If there are other \r, count extra lines */
   return line;
 }
 
+/*---------------------------------------------------------------------------*\
+|                                                                             |
+|  Function         loadFile                                                  |
+|                                                                             |
+|  Description      Get the whole file contents in memory                     |
+|                                                                             |
+|  Input            FILE *f          The open file                            |
+|                   size_t *pSize    [OUT] The file size                      |
+|                                                                             |
+|  Output           The file data, or NULL and errno set if failed            |
+|                                                                             |
+|  Notes            Disk files are mapped in memory if possible. Their pages  |
+|                   are then read on demand, and shared with the system       |
+|                   cache, instead of being copied in the heap.               |
+|                   Other files, like pipes, are read in a growing buffer.    |
+|                                                                             |
+|  History                                                                    |
+|    2026-10-18 JFL Initial implementation                                    |
+|                                                                             |
+\*---------------------------------------------------------------------------*/
+
+#ifdef _MSDOS
+#define LOAD_BLOCK 0x1000U	/* Initial buffer size */
+#else
+#define LOAD_BLOCK 0x10000L	/* Initial buffer size */
+#endif
+
+char *loadFile(FILE *f, size_t *pSize) {
+  char *pData = NULL;
+  size_t nData = 0;		/* Number of bytes read */
+  size_t lData = 0;		/* Number of bytes allocated */
+  size_t nRead;
+#if HAS_MMAP
+  struct stat st;
+
+  if (   !fstat(fileno(f), &st) && S_ISREG(st.st_mode) && st.st_size
+      && ((off_t)(size_t)st.st_size == st.st_size)) {
+    void *pBase = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if (pBase != MAP_FAILED) {
+      madvise(pBase, (size_t)st.st_size, MADV_SEQUENTIAL);
+      *pSize = (size_t)st.st_size;
+      return pBase;
+    }
+  }
+#endif
+
+  do {
+    if (nData == lData) {	/* Double the buffer size */
+      size_t l = lData + (lData ? lData : LOAD_BLOCK);
+      char *p;
+      if (l < lData) l = (size_t)-1; /* Use all the address space left */
+      if (l == lData) {
+	free(pData);
+	errno = EFBIG;
+	return NULL;
+      }
+      p = realloc(pData, l);
+      if (!p) outOfMem();
+      pData = p;
+      lData = l;
+    }
+    nRead = fread(pData + nData, 1, lData - nData, f);
+    nData += nRead;
+  } while (nRead);
+  if (ferror(f)) {
+    free(pData);
+    return NULL;
+  }
+  *pSize = nData;
+  return pData;
+}
+
 /*----------------------------------------------------------------------------+
 |                                                                             |
 |  Function         processFile                                               |
@@ -361,47 +493,83 @@ char *getLine(char **pBuf, size_t *pBufSize, FILE *f, size_t offset, long *pNLin
 |  Description      Digest a .INI file. Build sorted lists of sections & items|
 |                                                                             |
 |  Input            char *argname    File name received from the command line |
-|                   dict_t *sections Dictionary of all sections               |
+|                   iniFile *pFile   [OUT] The file name, sections and items  |
+|                                                                             |
+|  Output           None                                                      |
 |                                                                             |
-|  Output           Pointer to the actual name of the .INI file analysed      |
+|  Notes            The file is parsed in place in memory. Names and values   |
+|                   are slices of the file data. Only the lines that must be  |
+|                   rewritten, because they continue on the next lines, are   |
+|                   assembled in a scratch buffer, and copied to the arena.   |
 |                                                                             |
 |  History                                                                    |
 |    1993-09-29 JFL Initial implementation                                    |
 |    2016-01-05 JFL Added support for quoted value names, that may contain '='.
 |                   Added support for continuation lines.                     |
+|    2026-10-18 JFL Parse the file data in memory, without copying it.        |
+|                   Merge homonym sections, instead of losing the items of    |
+|                   all but the first. Continuation lines may continue too,   |
+|                   even if not indented. Stop at the end of the file within  |
+|                   quoted names and values, instead of looping forever.      |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-#define LINESIZE 256	/* Initial maximum line size. Will grow if needed */
-			/* Some registry paths are longer than 256 characters */
-			/* Must not be too large, else the small DOS version will fail to work */
+#if HAS_PARALLEL
+/* Thread routine for processFile(). pFile->pszName is the argument on entry */
+void *processFileThread(void *pArg) {
+  iniFile *pFile = pArg;
+  processFile(pFile->pszName, pFile);
+  return NULL;
+}
+#endif
+
+/* Append text to a line, after copying that line into the scratch buffer if needed */
+const char *appendLine(PFBUF *pBuf, const char *line, size_t l, const char *pc, size_t n) {
+  if (line != pBuf->pBuf) {	/* The line is still in the file data */
+    pBuf->nBuf = 0;
+    if (PFWrite(pBuf, line, l)) outOfMem();
+  } else {			/* The line is already in the scratch buffer */
+    pBuf->nBuf = l;
+  }
+  if (n && PFWrite(pBuf, pc, n)) outOfMem();
+  return pBuf->pBuf;
+}
+
+/* Search the closing quote from line[i], skipping escaped characters. Return e if not found */
+size_t endOfQuotes(const char *line, size_t i, size_t e) {
+  for ( ; (i < e) && (line[i] != '"'); i += 1) {
+    if (line[i] == '\\') i += 1; /* Skip any escaped character. Ex: \" or \\ */
+  }
+  return (i < e) ? i : e;
+}
 
-char *processFile(char *argname, dict_t *sections) {
-  size_t lineSize = LINESIZE;
-  char *line;
+void processFile(char *argname, iniFile *pFile) {
+  const char *line;	/* The current line, in the file data or in buf */
+  size_t l;		/* Its length */
+  const char *next;	/* The next line */
+  size_t lNext;		/* Its length */
   long nl;
-  char *pc;
-  char *pc2;
+  const char *pc;
+  const char *pEnd;
+  char *pData;
+  size_t nData;
   FILE *f = NULL;
   char *fname;
-  dict_t *items;
-  dict_t *items0;
-  size_t l;
+  char *pExt;
+  PFBUF buf = {0};	/* Scratch buffer for lines that continue on the next ones */
   int iRegEdit = 0;	/* REGEDIT .reg file version */
-  char bom[4];
   char *pszEncoding = "Windows";
 
-  line = malloc(lineSize);
-  if (!line) outOfMem();
-
   /* Open file */
 
-  strcpy(line, argname);
-  if ( ((pc = strrchr(line, '.')) == NULL) || (strchr(pc, '\\') != NULL) ) {
+  fname = malloc(strlen(argname) + 5);
+  if (!fname) outOfMem();
+  strcpy(fname, argname);
+  if ( ((pExt = strrchr(fname, '.')) == NULL) || (strchr(pExt, '\\') != NULL) ) {
     /* If no dot found or there's a backslash afterwards */
-    strcat(line, ".ini");
+    strcat(fname, ".ini");
   }
-  fname = strdup(line);
+  pFile->pszName = fname;
 
   f = fopen(fname, "rb");
   if (!f) {
@@ -412,288 +580,543 @@ char *processFile(char *argname, dict_t *sections) {
   DEBUG_PRINTF(("\n\n"));
   if (verbose) fprintf(stderr, "Reading %s\n", fname);
 
+  pData = loadFile(f, &nData);
+  if (!pData) {
+    fprintf(stderr, "Error: Can't read file %s. %s.\n", fname, strerror(errno));
+    exit(1);
+  }
+  fclose(f);
+  pc = pData;
+  pEnd = pData + nData;
+
   /* Check the encoding */
   /* TO DO: Use that information to convert the input data to UTF8 */
-  l = fread(bom, 1, sizeof(bom), f);
-  if (!strncmp(bom, "\xEF\xBB\xBF", 3)) {
+  if ((nData >= 3) && !memcmp(pc, "\xEF\xBB\xBF", 3)) {
     pszEncoding = "UTF8";
-    fseek(f, 3L, SEEK_SET);
-  } else if (   !strncmp(bom, "\xFF\xFE", 2)
-	     || ((l >= 4) && !bom[1] && !bom[3])) {
+    pc += 3;
+  } else if (   ((nData >= 2) && !memcmp(pc, "\xFF\xFE", 2))
+	     || ((nData >= 4) && !pc[1] && !pc[3])) {
     pszEncoding = "UTF16";
 bad_encoding:
     fprintf(stderr, "Error: File %s is encoded as %s. Please convert it to ANSI or UTF8 first.\n", fname, pszEncoding);
     exit(1);
-  } else if (   !strncmp(bom, "\xFE\xFF", 2)
-	     || ((l >= 4) && !bom[0] && !bom[2])) {
+  } else if (   ((nData >= 2) && !memcmp(pc, "\xFE\xFF", 2))
+	     || ((nData >= 4) && !pc[0] && !pc[2])) {
     pszEncoding = "UTF16BE";
     goto bad_encoding;
-  } else { /* Assume this is in the default Windows encoding */
-    rewind(f);
-  }
+  } /* Else assume this is in the default Windows encoding */
 
   /* Read it & classify lines */
 
   nl = 0;
-  items0 = items = NewIniValueDict();
-  NewDictValue(sections, "", items);	/* The initial unnamed section */
-  while (getLine(&line, &lineSize, f, 0, &nl)) {
-    l = strlen(line);
+  newSection(pFile, "", 0, FALSE);	/* The initial unnamed section */
+  while ((line = getLine(&pc, pEnd, &l, &nl)) != NULL) {
+    size_t s, e;	/* Start and end of the trimmed line */
+    size_t i;
+    size_t iName, iNameEnd;
+    size_t iEqual;	/* Index of the = sign, or e if none */
+
     /* Check if the line ends with an \, showing that there's a continuation line */
-check_if_continuation_line:
-    if (l && line[l-1] == '\n') line[--l] = '\0'; /* Trim the final \n */
-    while (l && line[l-1] == '\r') {line[--l] = '\0';} /* Trim all \r before that \n */
-    if (l && line[l-1] == '\\') { /* There is a continuation line */
-      size_t i;
-      line[--l] = '\0';				  /* Trim the final \ */
-      getLine(&line, &lineSize, f, l, &nl);
-      i = l;
-      while (line[l] == ' ') {
-      	for (i = l; (line[i] = line[i+1]) != '\0'; i += 1) ;	/* Move the line ahead by 1 char */
-      }
-      l = i;				/* Record the new line length */
-      goto check_if_continuation_line;
+    for (;;) {
+      if (l && line[l-1] == '\n') l -= 1;	/* Trim the final \n */
+      while (l && line[l-1] == '\r') l -= 1;	/* Trim all \r before that \n */
+      if (!l || line[l-1] != '\\') break;
+      l -= 1;					/* Trim the final \ */
+      next = getLine(&pc, pEnd, &lNext, &nl);
+      if (!next) lNext = 0;
+      for ( ; lNext && (*next == ' '); lNext--) next += 1; /* Skip its indentation */
+      line = appendLine(&buf, line, l, next, lNext);
+      l += lNext;
     }
 
-    trimRight(line);                    /* Remove trailing blanks and \n */
-    pc = trimLeft(line);                /* Skip blanks */
-    if (!*pc || (*pc == ';')) continue; /* Ignore blank lines & comments */
+    for (e = l; e && isspace((unsigned char)line[e-1]); e--) ;	/* Remove trailing blanks */
+    for (s = 0; (s < e) && isspace((unsigned char)line[s]); s++) ; /* Skip blanks */
+    if ((s == e) || (line[s] == ';')) continue; /* Ignore blank lines & comments */
 
-    DEBUG_PRINTF(("Line %lu %s\n", nl, line));
+    DEBUG_PRINTF(("Line %lu %.*s\n", nl, (int)e, line));
 
-    if (*pc == '[') {                   /* If it's a section */
-      pc += 1;				/* Skip the '[' */
-      pc = trimLeft(pc);                /* Skip blanks */
-      pc2 = strrchr(pc, ']');
-      if (!pc2) {
-	fprintf(stderr, "Error in file %s line %ld: Missing end of section name:\n%s\n", fname, nl, line);
+    if (line[s] == '[') {		/* If it's a section */
+      for (s += 1; (s < e) && isspace((unsigned char)line[s]); s++) ; /* Skip the '[' and blanks */
+      for (i = e; (i > s) && (line[i-1] != ']'); i--) ; /* Search the last ']' */
+      if (i == s) {
+	fprintf(stderr, "Error in file %s line %ld: Missing end of section name:\n%.*s\n", fname, nl, (int)e, line);
 	continue;                   /* If no ], try next line */
       }
-      *(pc2) = '\0';
-      trimRight(pc);
-      items = NewIniValueDict();
-      NewDictValue(sections, pc, items);
+      for (i -= 1; (i > s) && isspace((unsigned char)line[i-1]); i--) ;
+      newSection(pFile, line+s, i-s, (line == buf.pBuf));
       continue;
     }
 
     /* Else it's an item line */
-    if (*pc == '"') {	/* It's a quoted name */
-      pc2 = pc += 1;		/* Skip the opening quote */
-search_end_of_quoted_name:
-      for ( ; *pc2 && (*pc2 != '"'); pc2 += 1) {	/* Search the closing quote */
-      	if (*pc2 == '\\') pc2 += 1; /* Skip any escaped character. Ex: \" or \\ */
+    if (line[s] == '"') {	/* It's a quoted name */
+      iName = s + 1;		/* Skip the opening quote */
+      i = iName;
+      while ((i = endOfQuotes(line, i, e)) == e) {
+	/* The quoted name continues on next line (rare, but happens) */
+	next = getLine(&pc, pEnd, &lNext, &nl);
+	if (!next) break;
+	line = appendLine(&buf, line, e, "\\\n", 2); /* Record an escaped new line */
+	line = appendLine(&buf, line, e+2, next, lNext);
+	i = e + 2;
+	e = l = i + lNext;
       }
-      if (*pc2 == '"') {
-      	*pc2 = '\0';		/* Remove the closing quote */
-      	pc2 = strchr(pc2+1, '=');
-      } else {	/* The quoted name continues on next line (rare, but happens) */
-      	char *line0 = line;
-      	*(pc2++) = '\\'; /* Record an escaped new line */
-      	*(pc2++) = '\n';
-      	*pc2 = '\0';
-      	getLine(&line, &lineSize, f, pc2-line, &nl);
-      	if (line != line0) {
-      	  pc += (line-line0);
-      	  pc2 += (line-line0);
-      	}
-      	goto search_end_of_quoted_name;
+      iNameEnd = i;
+      iEqual = e;
+      if (i < e) {		/* Search the = after the closing quote */
+	for (iEqual = i+1; (iEqual < e) && (line[iEqual] != '='); iEqual++) ;
       }
     } else {		/* Unquoted name */
-      pc2 = strchr(pc, '=');
-      if (pc2) *pc2 = '\0';	/* Remove the equal sign */
-      trimRight(pc);
+      iName = s;
+      for (iEqual = s; (iEqual < e) && (line[iEqual] != '='); iEqual++) ;
+      for (iNameEnd = iEqual; (iNameEnd > iName) && isspace((unsigned char)line[iNameEnd-1]); iNameEnd--) ;
     }
-    if (!pc2) {
+    if (iEqual == e) {
+      char szHead[64];
       if (allowNoValue) { /* If we allow non-standard .ini files with value-less lines */
-	NewDictValue(items, pc, NULL); /* Enter them without a value */
+	newItem(pFile, line+iName, iNameEnd-iName, NULL, 0, (line == buf.pBuf)); /* Enter them without a value */
       	continue;
       }
-      if (   (items == items0)
-      	  && (   sscanf(pc, "Windows Registry Editor Version %d", &iRegEdit)
-	      || sscanf(pc, "REGEDIT%d", &iRegEdit))
+      i = iNameEnd - iName;
+      if (i >= sizeof(szHead)) i = sizeof(szHead) - 1;
+      memcpy(szHead, line+iName, i);
+      szHead[i] = '\0';
+      if (   (pFile->nSections == 1)
+      	  && (   sscanf(szHead, "Windows Registry Editor Version %d", &iRegEdit)
+	      || sscanf(szHead, "REGEDIT%d", &iRegEdit))
       	  ) { /* regedit .reg files header. Version varies. */
-	NewDictValue(items, pc, NULL); /* Enter it without a value */
+	newItem(pFile, line+iName, iNameEnd-iName, NULL, 0, (line == buf.pBuf)); /* Enter it without a value */
       	continue;
       }
-      fprintf(stderr, "Error in file %s line %ld: Unexpected (continuation?) line:\n%s\n", fname, nl, line);
+      fprintf(stderr, "Error in file %s line %ld: Unexpected (continuation?) line:\n%.*s\n", fname, nl, (int)e, line);
       continue;
     }
-    pc2 = trimLeft(pc2+1);
-    if (iRegEdit && (*pc2 == '"')) { /* It's a quoted value */
-      char *pc3;
-      pc3 = pc2 += 1;			/* Skip the opening quote */
-search_end_of_quoted_value:
-      for ( ; *pc3 && (*pc3 != '"'); pc3 += 1) { /* Search the closing quote */
-      	if (*pc3 == '\\') pc3 += 1; /* Skip any escaped character. Ex: \" or \\ */
-      }
-      if (*pc3 == '"') {	/* We reached the end of string */
-      	*pc3 = '\0';			/* Remove the closing quote */
-      } else {			/* The string continues on next line */
-      	char *line0 = line;
-      	if (*(pc3-1) != '\n') { /* The first line had its \n trimmed above */
+    for (s = iEqual+1; (s < e) && isspace((unsigned char)line[s]); s++) ;
+    if (iRegEdit && (s < e) && (line[s] == '"')) { /* It's a quoted value */
+      s += 1;			/* Skip the opening quote */
+      i = s;
+      while ((i = endOfQuotes(line, i, e)) == e) {
+	/* The string continues on next line */
+	next = getLine(&pc, pEnd, &lNext, &nl);
+	if (!next) break;
+	if (line[e-1] != '\n') { /* The first line had its \n trimmed above */
 #if defined(_MSDOS) || defined(_WIN32)
-	  *(pc3++) = '\r';
+	  line = appendLine(&buf, line, e, "\r\n", 2);
+	  e += 2;
+#else
+	  line = appendLine(&buf, line, e, "\n", 1);
+	  e += 1;
 #endif
-	  *(pc3++) = '\n';
-	  *pc3 = '\0';
 	}
-      	getLine(&line, &lineSize, f, pc3-line, &nl);
-      	if (line != line0) {
-      	  pc += (line-line0);
-      	  pc2 += (line-line0);
-      	  pc3 += (line-line0);
-      	}
-      	goto search_end_of_quoted_value;
+	line = appendLine(&buf, line, e, next, lNext);
+	i = e;
+	e = l = i + lNext;
       }
+      e = i;			/* Remove the closing quote */
     }
-    NewDictValue(items, pc, strdup(pc2));
+    newItem(pFile, line+iName, iNameEnd-iName, line+s, e-s, (line == buf.pBuf));
   }
 
   /* Cleanup */
-  fclose(f);
-  free(line);
+  free(buf.pBuf);
 
-  return fname;
+  sortFile(pFile);
 }
 
-/*----------------------------------------------------------------------------+
+/*---------------------------------------------------------------------------*\
 |                                                                             |
-|   Function:       trim                                                      |
+|  Function         newSection, newItem                                       |
 |                                                                             |
-|   Description:    Remove spaces from the ends of a string                   |
+|  Description      Record a new section part, or a new item in the last one  |
 |                                                                             |
-|   Input:          char *s     String to trim                                |
+|  Input            iniFile *pFile   The file                                 |
+|                   const char *pc   The section name. Not NUL-terminated     |
+|                   size_t l         Its length                               |
+|                   int iCopy        TRUE=Copy the strings to the arena       |
 |                                                                             |
-|   Output:         The string address, which may have shifted a bit.         |
+|  Output           None                                                      |
 |                                                                             |
-|   Notes:                                                                    |
+|  Notes            The strings must be copied if they were rewritten in the  |
+|                   scratch buffer, as it is reused for the next lines.       |
 |                                                                             |
-|   History:                                                                  |
-|    2010-07-10 JFL Initial implementation                                    |
-|    2017-01-02 JFL Fixed trimRight.                                          |
+|  History                                                                    |
+|    2026-10-18 JFL Initial implementation                                    |
 |                                                                             |
-+----------------------------------------------------------------------------*/
+\*---------------------------------------------------------------------------*/
 
-char *trimLeft(char *s) {
-  while (isspace(*s)) s++;
+slice newSlice(arena_t *pArena, const char *pc, size_t l, int iCopy) {
+  slice s;
+  if (iCopy) {
+    char *pc2 = ArenaAlloc(pArena, l ? l : 1);
+    memcpy(pc2, pc, l);
+    pc = pc2;
+  }
+  s.pc = pc;
+  s.l = l;
   return s;
 }
 
-char *trimRight(char *s) {
-  size_t l = strlen(s);
-  for ( ; (l--) && isspace(s[l]); ) {
-    s[l] = '\0';
+void newSection(iniFile *pFile, const char *pc, size_t l, int iCopy) {
+  iniSection *ps;
+
+  if (pFile->nSections == pFile->lSections) {
+    pFile->lSections = pFile->lSections ? 2 * pFile->lSections : 256;
+    pFile->pSections = realloc(pFile->pSections, pFile->lSections * sizeof(iniSection));
+    if (!pFile->pSections) outOfMem();
   }
-  return s;
+  ps = pFile->pSections + pFile->nSections;
+  ps->name = newSlice(&pFile->arena, pc, l, iCopy);
+  ps->nName = normalizeName(&pFile->arena, ps->name);
+  ps->iPart = pFile->nSections++;
+  ps->iItem = pFile->nItems;
+  ps->pItems = NULL;
+  ps->nItems = 0;
 }
 
-/*----------------------------------------------------------------------------+
+void newItem(iniFile *pFile, const char *pName, size_t lName, const char *pValue, size_t lValue, int iCopy) {
+  iniItem *pi;
+
+  if (pFile->nItems == pFile->lItems) {
+    pFile->lItems = pFile->lItems ? 2 * pFile->lItems : 1024;
+    pFile->pItems = realloc(pFile->pItems, pFile->lItems * sizeof(iniItem));
+    if (!pFile->pItems) outOfMem();
+  }
+  pi = pFile->pItems + pFile->nItems;
+  pi->name = newSlice(&pFile->arena, pName, lName, iCopy);
+  pi->nName = normalizeName(&pFile->arena, pi->name);
+  if (pValue) {
+    pi->value = newSlice(&pFile->arena, pValue, lValue, iCopy);
+  } else {
+    pi->value.pc = NULL;
+    pi->value.l = 0;
+  }
+  pi->nValue = normalize(&pFile->arena, pi->value, !compBlanks);
+  pi->iItem = pFile->nItems++;
+  pFile->pSections[pFile->nSections-1].nItems += 1;
+}
+
+/*---------------------------------------------------------------------------*\
 |                                                                             |
-|  Function         compItem                                                  |
+|  Function         sortFile                                                  |
 |                                                                             |
-|  Description      Compare two item structures (actually pointers to ...)    |
+|  Description      Sort sections and items, and merge duplicates             |
 |                                                                             |
-|  Input            dictnode *i1    Structure 1                               |
-|                   dictnode *i2    Structure 2                               |
+|  Input            iniFile *pFile   The file, with its items in file order   |
 |                                                                             |
-|  Output            0 if *i1 = *i2                                           |
-|                   <0 if *i1 < *i2                                           |
-|                   >0 if *i1 > *i2                                           |
+|  Output           None                                                      |
+|                                                                             |
+|  Notes            Sections are sorted by name, and homonym sections merged. |
+|                   The items of a section part follow each other, so they    |
+|                   are sorted in place. Only those of homonym sections are   |
+|                   copied together. Sorting many small sections is faster    |
+|                   than sorting all items at once.                           |
+|                   Items with the same name and value are merged. The first  |
+|                   one found in the file is kept.                            |
+|                   Names and values are compared ignoring case if            |
+|                   ignoreCase, but not ignoring blanks.                      |
 |                                                                             |
 |  History                                                                    |
-|    1993-09-29 JFL Initial implementation                                    |
-|    2017-01-01 JFL Rewritten to handle dictnode items.                       |
+|    2026-10-18 JFL Initial implementation                                    |
 |                                                                             |
-+----------------------------------------------------------------------------*/
+\*---------------------------------------------------------------------------*/
 
-int compItem(dictnode *i1, dictnode *i2)
-    {
-    int dif;
+int compSections(const void *p1, const void *p2) {
+  const iniSection *ps1 = p1;
+  const iniSection *ps2 = p2;
+  int dif = compSlice(&ps1->nName, &ps2->nName, FALSE);
+  if (dif) return dif;
+  return (ps1->iPart > ps2->iPart) - (ps1->iPart < ps2->iPart);
+}
 
-    dif = compString(i1->pszKey, i2->pszKey);	/* Compare names */
-    if (dif) return dif;
+int compValues(const slice *ps1, const slice *ps2) {
+  if (!ps1->pc || !ps2->pc) return (ps1->pc != NULL) - (ps2->pc != NULL); /* Items without a value come first */
+  return compSlice(ps1, ps2, ignoreCase);
+}
 
-    if (!i1->pData && !i2->pData) return 0;
-    if (!i1->pData &&  i2->pData) return -1;
-    if ( i1->pData && !i2->pData) return 1;
+int compItems(const void *p1, const void *p2) { /* Items in the same section */
+  const iniItem *pi1 = p1;
+  const iniItem *pi2 = p2;
+  int dif = compSlice(&pi1->nName, &pi2->nName, FALSE);
+  if (!dif) dif = compValues(&pi1->value, &pi2->value);
+  if (dif) return dif;
+  return (pi1->iItem > pi2->iItem) - (pi1->iItem < pi2->iItem);
+}
+
+void sortFile(iniFile *pFile) {
+  iniSection *pSections = pFile->pSections;
+  size_t i, j, n;
 
-    return compStringNB(i1->pData, i2->pData);
+  /* Sort sections, and merge homonym section parts */
+  qsort(pSections, pFile->nSections, sizeof(iniSection), compSections);
+  for (i = n = 0; i < pFile->nSections; i = j) {
+    size_t nItems = pSections[i].nItems;
+    for (j = i+1; (j < pFile->nSections) && !compSlice(&pSections[i].nName, &pSections[j].nName, FALSE); j++) {
+      nItems += pSections[j].nItems;
     }
+    pSections[n] = pSections[i];
+    pSections[n].pItems = pFile->pItems + pSections[i].iItem;
+    if ((j - i) > 1) {	/* Copy the items of all parts together */
+      iniItem *pi = malloc((nItems ? nItems : 1) * sizeof(iniItem));
+      if (!pi) outOfMem();
+      pSections[n].pItems = pi;
+      for ( ; i < j; i++) {
+	memcpy(pi, pFile->pItems + pSections[i].iItem, pSections[i].nItems * sizeof(iniItem));
+	pi += pSections[i].nItems;
+      }
+      pSections[n].nItems = nItems;
+    }
+    n += 1;
+  }
+  pFile->nSections = n;
+
+  /* Sort the items in each section, and merge duplicate items */
+  for (i = 0; i < pFile->nSections; i++) {
+    iniSection *ps = pSections + i;
+    if (ps->nItems > 1) qsort(ps->pItems, ps->nItems, sizeof(iniItem), compItems);
+    for (j = n = 0; j < ps->nItems; j++) {
+      if (   n
+	  && !compSlice(&ps->pItems[n-1].nName, &ps->pItems[j].nName, FALSE)
+	  && !compValues(&ps->pItems[n-1].value, &ps->pItems[j].value)) continue;
+      ps->pItems[n++] = ps->pItems[j];
+    }
+    ps->nItems = n;
+  }
+}
 
 /*----------------------------------------------------------------------------+
 |                                                                             |
-|  Function         compStringNB                                              |
+|  Function         ArenaAlloc                                                |
 |                                                                             |
-|  Description      Compare two strings, possibly ignoring blanks and/or case |
+|  Description      Allocate memory for a string that will never be freed     |
 |                                                                             |
-|  Input            char *s1        String 1                                  |
-|                   char *s2        String 2                                  |
+|  Input            arena_t *pArena  The arena to allocate from               |
+|                   size_t n         Number of bytes needed                   |
 |                                                                             |
-|  Output            0 if string1 = string2                                   |
-|                   <0 if string1 < string2                                   |
-|                   >0 if string1 > string2                                   |
+|  Output           Address of the memory block. Aborts if out of memory.     |
+|                                                                             |
+|  Notes            Allocating many small strings from large blocks saves     |
+|                   the time and the memory overhead of individual mallocs.   |
+|                   Strings larger than 1/4 of a block get their own block.   |
 |                                                                             |
 |  History                                                                    |
-|    1993-09-29 JFL Initial implementation                                    |
-|    2017-01-05 JFL Removed the dependancy on the LINESIZE constant.          |
+|    2026-10-18 JFL Initial implementation                                    |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-int compStringNB(const char *s1, const char *s2)
-    {
-    const char *p1;
-    char *p2;
-    char c;
+char *ArenaAlloc(arena_t *pArena, size_t n) {
+  char *p;
 
-    if (compBlanks)
-        {
-        return compString(s1, s2);
-        }
-    else
-        {
-        char *line1, *line2;
-        int dif;
-
-        line1 = malloc(strlen(s1) + 1);
-        if (!line1) outOfMem();
-        line2 = malloc(strlen(s2) + 1);
-        if (!line2) outOfMem();
-
-        for (p1=s1, p2=line1; (c=*p1) != 0; p1++) if (c != ' ') *(p2++) = c;
-        *p2 = '\0';
-        for (p1=s2, p2=line2; (c=*p1) != 0; p1++) if (c != ' ') *(p2++) = c;
-        *p2 = '\0';
-        dif = compString(line1, line2);
-        free(line1);
-        free(line2);
-        return dif;
-        }
+  if (n > pArena->nFree) {
+    if (n > (ARENA_BLOCK / 4)) {
+      p = malloc(n);
+      if (!p) outOfMem();
+      return p;
     }
+    pArena->pBuf = malloc(ARENA_BLOCK);
+    if (!pArena->pBuf) outOfMem();
+    pArena->nFree = ARENA_BLOCK;
+  }
+  p = pArena->pBuf;
+  pArena->pBuf += n;
+  pArena->nFree -= n;
+  return p;
+}
 
 /*----------------------------------------------------------------------------+
 |                                                                             |
-|   Function:       compString                                                |
+|  Function         normalize                                                 |
+|                                                                             |
+|  Description      Convert a string to the form used for comparisons         |
+|                                                                             |
+|  Input            arena_t *pArena  Where to store the converted string      |
+|                   slice s          The string to convert. s.pc may be NULL  |
+|                   int iNoBlanks    TRUE = Remove all spaces                 |
 |                                                                             |
-|   Description:    Compare two strings, possibly ignoring case               |
+|  Output           The converted string, or s itself if it needs no change   |
 |                                                                             |
-|   Input:          char *s1        String 1                                  |
-|                   char *s2        String 2                                  |
+|  Notes            Converted to lower case if ignoreCase, as _stricmp() does.|
+|                   So comparing the results with compSlice() gives the same  |
+|                   order as comparing the original strings with _stricmp().  |
 |                                                                             |
-|   Output:          0 if string1 = string2                                   |
+|  History                                                                    |
+|    2026-10-18 JFL Initial implementation                                    |
+|                                                                             |
++----------------------------------------------------------------------------*/
+
+slice normalize(arena_t *pArena, slice s, int iNoBlanks) {
+  const char *pc;
+  const char *pEnd = s.pc + s.l;
+  char *pc2;
+  char c;
+
+  if (!s.pc) return s;
+  for (pc = s.pc; pc < pEnd; pc++) { /* Check if anything needs to change */
+    c = *pc;
+    if (iNoBlanks && (c == ' ')) break;
+    if (ignoreCase && (c != tolower((unsigned char)c))) break;
+  }
+  if (pc == pEnd) return s;
+
+  pc2 = ArenaAlloc(pArena, s.l);
+  for (pc = s.pc, s.pc = pc2; pc < pEnd; pc++) {
+    c = *pc;
+    if (iNoBlanks && (c == ' ')) continue;
+    if (ignoreCase) c = (char)tolower((unsigned char)c);
+    *(pc2++) = c;
+  }
+  s.l = pc2 - s.pc;
+  return s;
+}
+
+/*---------------------------------------------------------------------------*\
+|                                                                             |
+|  Function         naturalKey                                                |
+|                                                                             |
+|  Description      Generate a binary key for sorting in the natural order    |
+|                                                                             |
+|  Input            const char *pc   The string                               |
+|                   size_t l         Its length                               |
+|                   char *pKey       Output buffer, or NULL to get the size   |
+|                                                                             |
+|  Output           The size of the key                                       |
+|                                                                             |
+|  Notes            Comparing the keys with memcmp() sorts the strings in the |
+|                   natural order, with numbers compared by value. Ex:        |
+|                   "a2" < "a12" < "a128" < "ab"                              |
+|                   Non-digit characters are copied unchanged. Each number    |
+|                   is replaced by '0', its number of significant digits,     |
+|                   these digits, and its number of leading zeros. The counts |
+|                   are stored as a series of 0xFF bytes for every 255, plus  |
+|                   one byte for the rest, so that they sort by value too.    |
+|                   Numbers still sort before the same characters as digits   |
+|                   did, and different strings always get different keys.     |
+|                   Ex: "a01" and "a1" are different names, with "a1" first.  |
+|                                                                             |
+|  History                                                                    |
+|    2026-10-18 JFL Initial implementation                                    |
+|                                                                             |
+\*---------------------------------------------------------------------------*/
+
+/* Store a count in the order-preserving format described above */
+size_t naturalCount(size_t n, char *pKey) {
+  size_t l = n / 255;
+  if (pKey) {
+    memset(pKey, '\xFF', l);
+    pKey[l] = (char)(n % 255);
+  }
+  return l + 1;
+}
+
+size_t naturalKey(const char *pc, size_t l, char *pKey) {
+  size_t i, j, nZeros, lKey = 0;
+
+  for (i = 0; i < l; ) {
+    if ((pc[i] < '0') || (pc[i] > '9')) {
+      if (pKey) pKey[lKey] = pc[i];
+      lKey += 1;
+      i += 1;
+      continue;
+    }
+    for (j = i; (j < l) && (pc[j] == '0'); j++) ;	/* Skip leading zeros */
+    nZeros = j - i;
+    i = j;
+    for ( ; (j < l) && (pc[j] >= '0') && (pc[j] <= '9'); j++) ; /* Find the end of the number */
+    if (pKey) pKey[lKey] = '0';
+    lKey += 1;
+    lKey += naturalCount(j - i, pKey ? pKey + lKey : NULL);
+    if (pKey) memcpy(pKey + lKey, pc + i, j - i);
+    lKey += j - i;
+    lKey += naturalCount(nZeros, pKey ? pKey + lKey : NULL);
+    i = j;
+  }
+  return lKey;
+}
+
+/* Normalize a section or item name, and convert it to a sort key if needed */
+slice normalizeName(arena_t *pArena, slice s) {
+  slice key;
+
+  s = normalize(pArena, s, FALSE);
+  if (!naturalSort || !s.l) return s;
+  key.l = naturalKey(s.pc, s.l, NULL);
+  if (key.l == s.l) return s;	/* Every number makes the key longer. So there's none */
+  key.pc = ArenaAlloc(pArena, key.l);
+  naturalKey(s.pc, s.l, (char *)key.pc);
+  return key;
+}
+
+/*---------------------------------------------------------------------------*\
+|                                                                             |
+|  Function         compSlice                                                 |
+|                                                                             |
+|  Description      Compare two strings slices, possibly ignoring case        |
+|                                                                             |
+|  Input            const slice *ps1 String 1                                 |
+|                   const slice *ps2 String 2                                 |
+|                   int iFold        TRUE = Ignore case                       |
+|                                                                             |
+|  Output            0 if string1 = string2                                   |
 |                   <0 if string1 < string2                                   |
 |                   >0 if string1 > string2                                   |
 |                                                                             |
-|   Updates:                                                                  |
+|  Notes            Same order as strcmp() or _stricmp() for C strings.       |
+|                                                                             |
+|  History                                                                    |
+|    2026-10-18 JFL Initial implementation                                    |
+|                                                                             |
+\*---------------------------------------------------------------------------*/
+
+int compSlice(const slice *ps1, const slice *ps2, int iFold) {
+  size_t l = (ps1->l < ps2->l) ? ps1->l : ps2->l;
+  int dif = 0;
+
+  if (!iFold) {
+    if (l) dif = memcmp(ps1->pc, ps2->pc, l);
+  } else {
+    const unsigned char *pc1 = (const unsigned char *)ps1->pc;
+    const unsigned char *pc2 = (const unsigned char *)ps2->pc;
+    size_t i;
+    for (i = 0; (i < l) && !dif; i++) dif = tolower(pc1[i]) - tolower(pc2[i]);
+  }
+  if (dif) return dif;
+  return (ps1->l > ps2->l) - (ps1->l < ps2->l);
+}
+
+/*----------------------------------------------------------------------------+
+|                                                                             |
+|  Function         compItem                                                  |
+|                                                                             |
+|  Description      Compare two items                                         |
+|                                                                             |
+|  Input            iniItem *i1      Item 1                                   |
+|                   iniItem *i2      Item 2                                   |
+|                                                                             |
+|  Output            0 if *i1 = *i2                                           |
+|                   <0 if *i1 < *i2                                           |
+|                   >0 if *i1 > *i2                                           |
+|                                                                             |
+|  Notes            Names are compared ignoring case, and values ignoring     |
+|                   blanks and case, as specified by the command line options.|
+|                   The normalized strings make this a binary comparison.     |
+|                                                                             |
+|  History                                                                    |
 |    1993-09-29 JFL Initial implementation                                    |
+|    2017-01-01 JFL Rewritten to handle dictnode items.                       |
+|    2026-10-18 JFL Compare the normalized names and values of indexed items. |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-int compString(const char *s1, const char *s2)
+int compItem(iniItem *i1, iniItem *i2)
     {
-    if (ignoreCase)
-        return stricmp(s1, s2);
-    else
-        return strcmp(s1, s2);
+    int dif;
+
+    dif = compSlice(&i1->nName, &i2->nName, FALSE);	/* Compare names */
+    if (dif) return dif;
+
+    if (!i1->nValue.pc && !i2->nValue.pc) return 0;
+    if (!i1->nValue.pc &&  i2->nValue.pc) return -1;
+    if ( i1->nValue.pc && !i2->nValue.pc) return 1;
+
+    return compSlice(&i1->nValue, &i2->nValue, FALSE);
     }
 
 /*----------------------------------------------------------------------------+
@@ -702,25 +1125,30 @@ int compString(const char *s1, const char *s2)
 |                                                                             |
 |  Description      Compare and display two sorted .INI files                 |
 |                                                                             |
-|  Input            char *name1     File 1 name                               |
-|                   dict_t *tree1   Tree section structure for file 1         |
-|                   char *name2     File 2 name                               |
-|                   dict_t *tree2   Tree section structure for file 2         |
+|  Input            iniFile *pFile1  File 1 name and sorted sections          |
+|                   iniFile *pFile2  File 2 name and sorted sections          |
 |                                                                             |
 |  Output           none                                                      |
 |                                                                             |
 |  History                                                                    |
 |    1993-09-29 JFL Initial implementation                                    |
 |    2017-01-01 JFL Adapted to dict_t types.                                  |
+|    2026-10-18 JFL Walk the sorted sections and items arrays.                |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-int compare(char *name1, dict_t *tree1, char *name2, dict_t *tree2)
+int compare(iniFile *pFile1, iniFile *pFile2)
     {
-    dictnode *n1, *n2;
-    dict_t *s1, *s2;		/* Section dictionaries */
-    dictnode *i1, *i2;		/* Items */
-    dictnode *i01, *i02;
+    char *name1 = pFile1->pszName;
+    char *name2 = pFile2->pszName;
+    iniSection *n1 = pFile1->pSections;	/* Sections */
+    iniSection *n2 = pFile2->pSections;
+    iniSection *n1End = n1 + pFile1->nSections;
+    iniSection *n2End = n2 + pFile2->nSections;
+    iniItem *i1, *i2;		/* Items */
+    iniItem *i1End, *i2End;
+    iniItem *i01 = NULL, *i02 = NULL;	/* First differing items */
+    int idiff;			/* TRUE if i01 and i02 are set. They may be NULL if a section is empty */
     outstate os;
     int sdone = FALSE;
     unsigned long nc = 0;	/* Number of comparisons done */
@@ -731,38 +1159,33 @@ int compare(char *name1, dict_t *tree1, char *name2, dict_t *tree2)
 
     os = EQUAL;
 
-    for (n1=FirstDictValue(tree1), n2=FirstDictValue(tree2); n1 || n2; )
+    while ((n1 < n1End) || (n2 < n2End))
         {
         int dif;
 
 	if (sdone) newOutState(&os, EQUAL, name1, name2); /* 2017-01-02 JFL Added to close EQUAL section */
 
-        s1 = s2 = NULL;
-        if (n1) s1 = n1->pData;
-        if (n2) s2 = n2->pData;
-	DEBUG_PRINTF(("// Comparing sections [%s] and [%s]\n", (n1 ? n1->pszKey : "(null)"), (n2 ? n2->pszKey : "(null)")));
-        if (!s1 && s2)
+	DEBUG_PRINTF(("// Comparing sections [%.*s] and [%.*s]\n", (int)((n1 < n1End) ? n1->name.l : 6), ((n1 < n1End) ? n1->name.pc : "(null)"), (int)((n2 < n2End) ? n2->name.l : 6), ((n2 < n2End) ? n2->name.pc : "(null)")));
+        if (n1 == n1End)
             dif = 1;
-        else if (s1 && !s2)
+        else if (n2 == n2End)
             dif = -1;
         else
-            dif = compString(n1->pszKey, n2->pszKey);
+            dif = compSlice(&n1->nName, &n2->nName, FALSE);
 
         if (dif < 0)
             {
             newOutState(&os, FILE1, name1, name2);
-            printSectName(n1->pszKey);
-            ForeachDictValue(s1, printItemCB, NULL);
-            n1 = NextDictValue(tree1, n1);
+            printSection(n1);
+            n1 += 1;
             continue;
             }
 
         if (dif > 0)
             {
             newOutState(&os, FILE2, name1, name2);
-            printSectName(n2->pszKey);
-            ForeachDictValue(s2, printItemCB, NULL);
-            n2 = NextDictValue(tree2, n2);
+            printSection(n2);
+            n2 += 1;
             continue;
             }
 
@@ -771,30 +1194,36 @@ int compare(char *name1, dict_t *tree1, char *name2, dict_t *tree2)
         newOutState(&os, EQUAL, name1, name2);
 
         sdone = FALSE;
-        i01 = i02 = NULL;
-	for (i1=FirstDictValue(s1), i2=FirstDictValue(s2); i1 || i2; )
+        idiff = FALSE;
+        i1 = n1->pItems;
+        i2 = n2->pItems;
+        i1End = i1 + n1->nItems;
+        i2End = i2 + n2->nItems;
+	while ((i1 < i1End) || (i2 < i2End))
             {
 	    nc += 1;
 	    if ((verbose) && ((nc % 10000) == 0)) fprintf(stderr, 
-	      "Processing value %lu: %s\\%s\n", nc, n1->pszKey, (i1 ? i1->pszKey : i2->pszKey)
+	      "Processing value %lu: %.*s\\%.*s\n", nc, (int)n1->name.l, n1->name.pc,
+	      (int)((i1 < i1End) ? i1->name.l : i2->name.l), ((i1 < i1End) ? i1->name.pc : i2->name.pc)
 	    );
-            DEBUG_PRINTF(("// Comparing values \"%s\" and \"%s\"\n", (i1 ? i1->pszKey : "(null)"), (i2 ? i2->pszKey : "(null)")));
-            if (!i1 || !i2) /* We're sure at least one of them is not NULL */
+            DEBUG_PRINTF(("// Comparing values \"%.*s\" and \"%.*s\"\n", (int)((i1 < i1End) ? i1->name.l : 6), ((i1 < i1End) ? i1->name.pc : "(null)"), (int)((i2 < i2End) ? i2->name.l : 6), ((i2 < i2End) ? i2->name.pc : "(null)")));
+            if ((i1 == i1End) || (i2 == i2End)) /* We're sure at least one of them is not at the end */
                 {
                 if (!sdone)
                     {
-                    printSectName(n1->pszKey);
+                    printSectName(&n1->name);
                     sdone = TRUE;
                     }
-                if (!i01 && !i02)   /* Remember the first difference */
+                if (!idiff)	    /* Remember the first difference */
                     {
                     i01 = i1;
                     i02 = i2;
+                    idiff = TRUE;
                     }
-                if (i1)
-                    i1 = NextDictValue(s1, i1);
+                if (i1 < i1End)
+                    i1 += 1;
                 else
-                    i2 = NextDictValue(s2, i2);
+                    i2 += 1;
                 continue;
                 }
 
@@ -804,47 +1233,48 @@ int compare(char *name1, dict_t *tree1, char *name2, dict_t *tree2)
                 {
                 if (!sdone)
                     {
-                    printSectName(n1->pszKey);
+                    printSectName(&n1->name);
                     sdone = TRUE;
                     }
-                if (!i01 && !i02)   /* Remember the first difference */
+                if (!idiff)	    /* Remember the first difference */
                     {
                     i01 = i1;
                     i02 = i2;
+                    idiff = TRUE;
                     }
                 if (dif < 0)
-                    i1 = NextDictValue(s1, i1);
+                    i1 += 1;
                 else
-                    i2 = NextDictValue(s2, i2);
+                    i2 += 1;
                 continue;
                 }
 
             /* No difference */
 
-            if (i01 || i02)         /* Display differing lines */
+            if (idiff)		    /* Display differing lines */
                 {
                 newOutState(&os, FILE1, name1, name2);
-                if (i01) for ( ; i01 != i1; i01 = NextDictValue(s1, i01)) printItem(i01);
+                for ( ; i01 < i1; i01++) printItem(i01);
                 newOutState(&os, FILE2, name1, name2);
-                if (i02) for ( ; i02 != i2; i02 = NextDictValue(s2, i02)) printItem(i02);
-                i01 = i02 = NULL;
+                for ( ; i02 < i2; i02++) printItem(i02);
+                idiff = FALSE;
                 }
 
-	    i1 = NextDictValue(s1, i1);
-	    i2 = NextDictValue(s2, i2);
+	    i1 += 1;
+	    i2 += 1;
             }
 
-        if (i01 || i02)         /* Display differing lines */
+        if (idiff)		/* Display differing lines */
             {
             newOutState(&os, FILE1, name1, name2);
-            if (i01) for ( ; i01; i01 = NextDictValue(s1, i01)) printItem(i01);
+            for ( ; i01 < i1End; i01++) printItem(i01);
             newOutState(&os, FILE2, name1, name2);
-            if (i02) for ( ; i02; i02 = NextDictValue(s2, i02)) printItem(i02);
-            i01 = i02 = NULL;
+            for ( ; i02 < i2End; i02++) printItem(i02);
+            idiff = FALSE;
             }
 
-	n1 = NextDictValue(tree1, n1);
-	n2 = NextDictValue(tree2, n2);
+	n1 += 1;
+	n2 += 1;
         }
 
     newOutState(&os, EQUAL, name1, name2);
@@ -907,40 +1337,28 @@ void newOutState(outstate *pold, outstate new, char *name1, char *name2)
 |                                                                             |
 |   Description:    Display a section name                                    |
 |                                                                             |
-|   Input:          section *ps     Pointer to the section to display         |
+|   Input:          slice *pName    The section name                          |
 |                                                                             |
 |   Output:         None                                                      |
 |                                                                             |
 |   Updates:                                                                  |
 |    1993-09-29 JFL Initial implementation                                    |
 |    2020-02-17 JFL No need to display the initial unnamed section [] name.   |
+|    2026-10-18 JFL Display slices. Added printSection().                     |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-#ifdef _MSC_VER
-#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning */
-#endif
-
-void *printSectNameCB(char *pszName, void *pValue, void *pRef)
+void printSectName(slice *pName)
     {
-    if (pszName[0]) printf("\n[%s]\n", pszName);
-    return NULL;
+    if (pName->l) printf("\n[%.*s]\n", (int)pName->l, pName->pc);
     }
 
-void *printSectCB(char *pszName, void *pValue, void *pRef)
+void printSection(iniSection *ps)
     {
-    if (pszName[0]) printf("\n[%s]\n", pszName);
-    ForeachDictValue(pValue, printItemCB, pRef);
-    return NULL;
-    }
-
-#ifdef _MSC_VER
-#pragma warning(default:4100) /* Restore the "unreferenced formal parameter" warning */
-#endif
+    size_t n;
 
-void printSectName(char *name)
-    {
-    printSectNameCB(name, NULL, NULL);
+    printSectName(&ps->name);
+    for (n = 0; n < ps->nItems; n++) printItem(ps->pItems + n);
     }
 
 /*----------------------------------------------------------------------------+
@@ -954,47 +1372,43 @@ void printSectName(char *name)
 |    2017-01-01 JFL Rewritten to be usable as a dict_t enumeration callback.  |
 |    2017-01-05 JFL Quote names containing spaces or =.                       |
 |    2020-02-17 JFL Don't quote free-style lines without a value.             |
+|    2026-10-18 JFL Display slices.                                           |
 |                                                                             |
 +----------------------------------------------------------------------------*/
 
-#ifdef _MSC_VER
-#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning */
-#endif
- 
-void *printItemCB(char *pszName, void *pValue, void *pRef)
+/* Check if a slice contains any of the characters in a set */
+int sliceHasAny(const slice *ps, const char *pszSet)
     {
-    char *pszValue = pValue;
-    if (   *pszName				    /* If the name is not empty */
-        && (   (!pszName[strcspn(pszName, "= \t")]) /* and if there are no spaces or = in the name */
-            || (!pszValue))			    /*     or we don't have a value */
+    size_t i;
+    for (i = 0; i < ps->l; i++) if (ps->pc[i] && strchr(pszSet, ps->pc[i])) return TRUE;
+    return FALSE;
+    }
+
+void printItem(iniItem *pi)
+    {
+    slice *pName = &pi->name;
+    slice *pValue = &pi->value;
+    if (   pName->l				    /* If the name is not empty */
+        && (   !sliceHasAny(pName, "= \t")	    /* and if there are no spaces or = in the name */
+            || !pValue->pc)			    /*     or we don't have a value */
     ) {
-      printf("    %s", pszName);
+      printf("    %.*s", (int)pName->l, pName->pc);
     } else {
-      printf("    \"%s\"", pszName);
+      printf("    \"%.*s\"", (int)pName->l, pName->pc);
     }
-    if (pszValue) {
-      size_t l = strlen(pszValue);
+    if (pValue->pc) {
+      size_t l = pValue->l;
       if (   !l					/* If the value is empty */
-      	  || pszValue[strcspn(pszValue, "\r\n")]/* or if it spans multiple lines */
-      	  || isspace(pszValue[0])		/* or if it begins with a space */
-      	  || (l && isspace(pszValue[l-1]))	/* or if it ends with a space */
+      	  || sliceHasAny(pValue, "\r\n")		/* or if it spans multiple lines */
+      	  || isspace((unsigned char)pValue->pc[0])	/* or if it begins with a space */
+      	  || isspace((unsigned char)pValue->pc[l-1])	/* or if it ends with a space */
       ) {
-	printf(" = \"%s\"", pszValue);
+	printf(" = \"%.*s\"", (int)l, pValue->pc);
       } else {
-	printf(" = %s", pszValue);
+	printf(" = %.*s", (int)l, pValue->pc);
       }
     }
     printf("\n");
-    return NULL;
-    }
-
-#ifdef _MSC_VER
-#pragma warning(default:4100) /* Restore the "unreferenced formal parameter" warning */
-#endif
- 
-void *printItem(dictnode *pi)
-    {
-    return printItemCB(pi->pszKey, pi->pData, NULL);
     }
 
 /*----------------------------------------------------------------------------+
@@ -1046,6 +1460,8 @@ Switches:\n\
   -C    Use case insensitive comparisons (Default)\n\
   -f    Allow non-standard data lines with a free string, without an =value\n\
   -F    Data lines must have a name=value format (Default)\n\
+  -n    Sort names in the natural order, with numbers compared by value\n\
+  -N    Sort names in the ASCII order (Default)\n\
   -v    Verbose node. Display extra progress information\n\
   -V    Display this program version and exit\n\
 \n\
@@ -50,6 +50,13 @@
 *    2020-04-20 JFL Added support for MacOS. Version 3.2.                     *
 *    2023-11-16 JFL Bugfix in the debug version: Buffer used after free().    *
 *                   Version 3.2.1.                                            *
+*    2026-10-18 JFL Added option -j to run commands in parallel in Unix, with *
+*		    their output displayed in the directory order.	      *
+*		    Version 3.3.					      *
+*    2026-10-18 JFL Added option -u to run commands in the directory order,   *
+*		    as soon as directories are found, using WalkDirTree().    *
+*		    Added options -depth, -n and -x to select directories.    *
+*		    Version 3.4.					      *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -57,8 +64,8 @@
 
 #define PROGRAM_DESCRIPTION "Execute a command recursively"
 #define PROGRAM_NAME    "redo"
-#define PROGRAM_VERSION "3.2.1"
-#define PROGRAM_DATE    "2023-11-16"
+#define PROGRAM_VERSION "3.4"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -76,6 +83,7 @@
 #include <limits.h>
 /* SysLib include files */
 #include "dirx.h"		/* Directory access functions eXtensions */
+#include "pathnames.h"		/* Pathname management definitions and functions */
 /* SysToolsLib include files */
 #include "debugm.h"	/* SysToolsLib debug macros */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
@@ -197,6 +205,8 @@ intptr_t spawnvp(int iMode, const char *pszCommand, char *const *argv);
 #define P_WAIT         0	/* Spawn mode: Wait for program termination */
 #define P_NOWAIT       1	/* Spawn mode: Do not wait for program termination */
 
+#define HAS_JOBS 1		/* fork() can start each job in its own directory */
+
 #endif /* __unix__ */
 
 /*********************************** Other ***********************************/
@@ -267,6 +277,12 @@ char szInitDir[PATHNAME_SIZE];      /* Initial directory on the work drive */
 char szStartDir[PATHNAME_SIZE];	    /* Directory where recursion starts */
 int iVerbose = FALSE;		    /* If TRUE, echo commands executed */
 int iRelat;			    /* Index of a pathname relative to szInitDir */
+int nJobs = 1;			    /* Max number of commands running in parallel */
+int iMaxDepth = -1;		    /* Max depth below the start directory. -1 = No limit */
+int iDepth = 0;			    /* Current depth below the start directory */
+char **ppszInclude = NULL;	    /* Name patterns of directories where to run the command */
+char **ppszExclude = NULL;	    /* Name patterns of directories to skip */
+char *pszSkipDir = NULL;	    /* Excluded directory which contents are being skipped */
 
 fif *firstfif = NULL;		    /* Pointer to the first allocated fif structure */
 
@@ -396,6 +412,9 @@ void finis(int retcode, ...);	    /* Return to the initial drive & exit */
 void usage(int iErr);               /* Display a brief help and exit */
 
 int descend(char *from, int fif0);  /* Recurse the directory tree */
+int walk(char *from);		    /* Walk the directory tree in the directory order */
+void DoPerPath(void);		    /* Run the command in the current directory */
+bool MatchesOneOf(const char *pszName, char **ppszPatterns); /* Does a name match one of the patterns? */
 int lis(char *, char *, int, ushort); /* Scan a directory */
 int CDECL cmpfif(const fif **ppfif1, const fif **ppfif2); /* Compare 2 names */
 void trie(fif **ppfif, int nfif);   /* Sort file names */
@@ -406,6 +425,11 @@ int makepathname(char *, char *, char *);
 
 char *getdir(char *, int);          /* Get the current drive directory */
 
+#if HAS_JOBS
+void StartJob(char *path, char **argv); /* Run a command in parallel */
+void WaitJobs(void);		    /* Wait for all jobs, and display their output */
+#endif
+
 /******************************************************************************
 *                                                                             *
 *	Function:	main						      *
@@ -435,12 +459,19 @@ int main(int argc, char *argv[]) {
   char *pszFrom = NULL;
   int iErr;
   char *pcd;
+  int iUnsorted = FALSE;
+  int nInclude = 0;
+  int nExclude = 0;
 
   _flushall(); /* Make sure the above line went to a file if the output is
 		  redirected */
 
   /* Parse the command line */
 
+  ppszInclude = calloc(argc, sizeof(char *)); /* There can't be more patterns than arguments */
+  ppszExclude = calloc(argc, sizeof(char *));
+  if (!ppszInclude || !ppszExclude) finis(RETCODE_NO_MEMORY, "Out of memory");
+
   for (i=1; i<argc; i++) {
     char *arg = argv[i];
     if ((arg[0] == '-') || (arg[0] == '/')) { /* It's a switch */
@@ -458,6 +489,14 @@ int main(int argc, char *argv[]) {
 	  continue;
 	}
       )
+      if (streq(option, "depth")) {
+	if ((i+1)<argc) {
+	  iMaxDepth = atoi(argv[++i]);
+	} else {
+	  usage(1);
+	}
+	continue;
+      }
       if (streq(option, "from")) {
 	if ((i+1)<argc) {
 	  pszFrom = argv[++i];
@@ -466,11 +505,34 @@ int main(int argc, char *argv[]) {
 	}
 	continue;
       }
+#if HAS_JOBS
+      if (streq(option, "j")) {
+	if ((i+1)<argc) {
+	  nJobs = atoi(argv[++i]);
+	  if (nJobs < 1) nJobs = 1;
+	} else {
+	  usage(1);
+	}
+	continue;
+      }
+#endif
+      if (streq(option, "n")) {
+	if ((i+1)<argc) {
+	  ppszInclude[nInclude++] = argv[++i];
+	} else {
+	  usage(1);
+	}
+	continue;
+      }
       if (streq(option, "q")) {
 	iVerbose = FALSE;
 	pszConclusion = NULL;
 	continue;
       }
+      if (streq(option, "u")) {
+	iUnsorted = TRUE;
+	continue;
+      }
       if (streq(option, "v")) {
 	iVerbose = TRUE;
 	continue;
@@ -479,12 +541,22 @@ int main(int argc, char *argv[]) {
 	puts(DETAILED_VERSION);
 	exit(0);
       }
+      if (streq(option, "x")) {
+	if ((i+1)<argc) {
+	  ppszExclude[nExclude++] = argv[++i];
+	} else {
+	  usage(1);
+	}
+	continue;
+      }
       printf("Unrecognized switch %s. Ignored.\n", arg);
       continue;
     }
     break;  /* Ignore other arguments */
   }
   arg1 = i;
+  if (!nInclude) ppszInclude = NULL;
+  if (!nExclude) ppszExclude = NULL;
 
   if (argc <= arg1) {   /* If there is no command line, exit immediately */
     usage(1);
@@ -546,7 +618,14 @@ int main(int argc, char *argv[]) {
   if (iRelat > 1) iRelat += 1;	// If not the root, account for the
 				      //  trailing backslash.
   /* Recurse */
-  descend(szStartDir, 0);
+  if (iUnsorted) {
+    walk(szStartDir);
+  } else {
+    descend(szStartDir, 0);
+  }
+#if HAS_JOBS
+  WaitJobs();
+#endif
 
   if (iVerbose) printf("%s\n", pszConclusion);
   finis(0);
@@ -574,8 +653,23 @@ PROGRAM_NAME_AND_VERSION " - " PROGRAM_DESCRIPTION "\n\
 Usage: redo [SWITCHES] {COMMAND LINE}\n\
 \n\
 Switches:\n\
+    -depth {N}    Do not go more than N levels below the start directory.\n\
     -from {path}  Start recursion in the given directory.\n\
+"
+#if HAS_JOBS
+"\
+    -j {N}        Run up to N commands in parallel. Their output is displayed\n\
+                  in the directory order, when each one is complete.\n\
+"
+#endif
+"\
+    -n {pattern}  Only run the command in directories matching the pattern.\n\
+                  May be repeated to select several patterns.\n\
+    -u            Unsorted. Walk the tree in the directory order, and run the\n\
+                  command as soon as each directory is found.\n\
     -v	          Echo each path accessed, and the command executed.\n\
+    -x {pattern}  Skip directories matching the pattern, and all their\n\
+                  subdirectories. May be repeated.\n\
 \n\
 Command line:     Any valid command and arguments.\n\
                   The special sequence \"{}\" is replaced by the current\n\
@@ -700,7 +794,9 @@ int descend(char *from, int fif0) {
     makepathname(name1, from, ppfif[i]->name);
     TRIM_PATHNAME_BUF(name1);
 
+    iDepth += 1;
     descend(name1, fif1);
+    iDepth -= 1;
 
     FREE_PATHNAME_BUF(name1);
   }
@@ -710,6 +806,96 @@ int descend(char *from, int fif0) {
   RETURN_INT(0);
 }
 
+/******************************************************************************
+*                                                                             *
+*       Function:       walk                                                  *
+*                                                                             *
+*       Description:    Go down the directory tree in the directory order     *
+*                                                                             *
+*       Arguments:                                                            *
+*                                                                             *
+*         char *from    First directory to list.                              *
+*                                                                             *
+*       Return value:   0=Success; !0=Failure                                 *
+*                                                                             *
+*       Notes:          Contrary to descend(), which lists and sorts all the  *
+*                       subdirectories of a directory before entering them,   *
+*                       this runs the command in every directory as soon as   *
+*                       WalkDirTree() finds it. So the first commands start   *
+*                       immediately, and the memory used does not depend on   *
+*                       the size of directories.                              *
+*                                                                             *
+*       Updates:                                                              *
+*	 2026-10-18 JFL	Initial implementation.				      *
+*                                                                             *
+******************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in callbacks */
+#endif
+
+/* WalkDirTree callback: Run the command in every directory selected */
+static int walkCB(const char *pszPath, const struct dirent *pDE, void *pRef) {
+  /* The tree is walked depth first. So the contents of an excluded
+     directory come right after it, and all begin with its pathname */
+  if (pszSkipDir) {
+    size_t l = strlen(pszSkipDir);
+    if (!strncmp(pszPath, pszSkipDir, l) && (pszPath[l] == DIRSEPARATOR)) return 0;
+    free(pszSkipDir);
+    pszSkipDir = NULL;
+  }
+  if (pDE->d_type != DT_DIR) return 0;
+  if (ppszExclude && MatchesOneOf(pDE->d_name, ppszExclude)) {
+    pszSkipDir = strdup(pszPath);
+    if (!pszSkipDir) finis(RETCODE_NO_MEMORY, "Out of memory for directory access");
+    return 0;
+  }
+  if (ppszInclude && !MatchesOneOf(pDE->d_name, ppszInclude)) return 0;
+  if (chdir(pszPath)) {
+    fprintf(stderr, "redo: Error: Cannot access directory %s.\n", pszPath);
+    return 0;
+  }
+  DoPerPath();
+  return 0;
+}
+
+#ifdef _MSC_VER
+#pragma warning(default:4100)
+#endif
+
+int walk(char *from) {
+  wdt_opts wdtOpts = {0};
+  char *pname;
+  int iRet = 0;
+
+  DEBUG_ENTER(("walk(\"%s\");\n", from));
+
+  /* Run the command in the start directory, which is the current directory */
+  pname = strrchr(from, DIRSEPARATOR);
+  pname = pname ? pname+1 : from;
+  if ((!ppszInclude) || MatchesOneOf(pname, ppszInclude)) DoPerPath();
+
+  /* Then in all subdirectories. Their pathnames are absolute, so they don't
+     depend on the current directory, which changes for every command. */
+  if (iMaxDepth) {
+    wdtOpts.iFlags = WDT_CONTINUE;
+    if (iMaxDepth > 0) wdtOpts.iMaxDepth = iMaxDepth;
+    iRet = WalkDirTree(from, &wdtOpts, walkCB, NULL);
+    free(pszSkipDir);
+    pszSkipDir = NULL;
+  }
+
+  RETURN_INT(iRet);
+}
+
+/* Check if a name matches one of a NULL-terminated list of patterns */
+bool MatchesOneOf(const char *pszName, char **ppszPatterns) {
+  for ( ; *ppszPatterns; ppszPatterns++) {
+    if (fnmatch(*ppszPatterns, pszName, FNM_CASEFOLD) == FNM_MATCH) return TRUE;
+  }
+  return FALSE;
+}
+
 /******************************************************************************
 *                                                                             *
 *	Function:	DoPerPath					      *
@@ -724,6 +910,7 @@ int descend(char *from, int fif0) {
 *                                                                             *
 *	History:							      *
 *	 1994-05-27 JFL	Updated for REDO.				      *
+*	 2026-10-18 JFL	With option -j, start a job, and return immediately.  *
 *                                                                             *
 ******************************************************************************/
 
@@ -787,14 +974,21 @@ void DoPerPath(void) {
   }
   command2[i] = NULL;
 
-  if (iVerbose) {
-    printf("[%s]", path);
-    for (i=0; (pc=command2[i]); i++) printf("%s ", pc);
-    printf("\n");
+#if HAS_JOBS
+  if (nJobs > 1) {	/* Run it in parallel. The job displays its own output */
+    StartJob(path, command2);
+  } else
+#endif
+  {
+    if (iVerbose) {
+      printf("[%s]", path);
+      for (i=0; (pc=command2[i]); i++) printf("%s ", pc);
+      printf("\n");
+    }
+    err = (int)spawnvp(P_WAIT, command2[0], command2);
+    if (err == -1) finis(RETCODE_EXEC_ERROR, "Cannot execute the command");
+    if (err) printf("\nredo: %s returns error # %d.\n", command2[0], err);
   }
-  err = (int)spawnvp(P_WAIT, command2[0], command2);
-  if (err == -1) finis(RETCODE_EXEC_ERROR, "Cannot execute the command");
-  if (err) printf("\nredo: %s returns error # %d.\n", command2[0], err);
 
   for (i=0; command2[i]; i++) free(command2[i]); // Free the copy of the command.
 
@@ -826,6 +1020,7 @@ void DoPerPath(void) {
 *                                                                             *
 *       Updates:                                                              *
 *	 1994-05-27 JFL	Updated for REDO.				      *
+*	 2026-10-18 JFL	Added the depth limit and the name patterns.	      *
 *                                                                             *
 ******************************************************************************/
 
@@ -940,11 +1135,14 @@ int lis(char *startdir, char *pattern, int nfif, ushort attrib) {
   pcd = getcwd(path, PATHNAME_SIZE);
   if (!pcd) finis(RETCODE_INACCESSIBLE, "Cannot get the current directory");
 
-  /* Execute the routine once for this path */
-  DoPerPath();
+  /* Execute the routine once for this path, if its name is selected */
+  pname = strrchr(path, DIRSEPARATOR);
+  pname = pname ? pname+1 : path;
+  if ((!ppszInclude) || MatchesOneOf(pname, ppszInclude)) DoPerPath();
 
-  /* start looking for all files */
-  pDir = opendirx(path);
+  /* start looking for all files, unless we're deep enough */
+  pDir = NULL;
+  if ((iMaxDepth < 0) || (iDepth < iMaxDepth)) pDir = opendirx(path);
   if (pDir) {
     while (pDir && (pDirent = readdirx(pDir))) { /* readdirx() ensures d_type is set */
       struct stat st;
@@ -976,6 +1174,8 @@ int lis(char *startdir, char *pattern, int nfif, ushort attrib) {
 		|| (pDirent->d_type != DT_DIR))
 	      DEBUG_CODE(&& (reason = "the pattern does not match"))
 	   && (fnmatch(pattern2, pDirent->d_name, FNM_CASEFOLD) == FNM_MATCH)
+	      DEBUG_CODE(&& (reason = "it's excluded"))
+	   && !(ppszExclude && MatchesOneOf(pDirent->d_name, ppszExclude))
 	 ) {
 	fif *pfif;
 
@@ -1295,3 +1495,180 @@ intptr_t spawnvp(int iMode, const char *pszCommand, char *const *argv) {
 
 #endif /* defined(_UNIX) */
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    StartJob, PollJobs, WaitJobs			      |
+|									      |
+|   Description:    Run commands in parallel, and display their output	      |
+|									      |
+|   Parameters:     char *path		Directory where to run the command    |
+|		    char **argv		List of arguments, terminated by NULL |
+|									      |
+|   Returns:	    Nothing. Aborts the program if a job cannot be started.   |
+|									      |
+|   Notes:	    Up to nJobs children run at the same time. Each one is    |
+|		    forked, changes to its own directory, and runs the	      |
+|		    command with its stdout and stderr redirected to a pipe.  |
+|		    							      |
+|		    The jobs are kept in a ring, in the order they were	      |
+|		    started, which is the directory order. The output of a    |
+|		    job is displayed in one block when it is complete, and    |
+|		    all jobs before it have been displayed. So the output is  |
+|		    the same as when running commands one at a time.	      |
+|		    							      |
+|		    The ring has room for more jobs than can run at the same  |
+|		    time, so that one slow job does not stop all others. But  |
+|		    as their output is kept in memory until it is displayed,  |
+|		    the ring size is bounded too.			      |
+|		    							      |
+|   History:								      |
+|    2026-10-18 JFL Created these routines.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#if HAS_JOBS
+
+#include <poll.h>
+#include <errno.h>
+
+typedef struct job {	    /* A command running in parallel */
+    pid_t pid;			/* Its process ID, or 0 when it has exited */
+    int fd;			/* Pipe with its output, or -1 after the end */
+    char *pBuf;			/* Its output so far */
+    size_t nBuf;		/* Number of bytes used */
+    size_t lBuf;		/* Number of bytes allocated */
+    int iStatus;		/* Its exit status, as returned by waitpid() */
+    char *pszCmd;		/* The command name, for error messages */
+} job;
+
+#define JOBS_PER_RUNNING 4	/* Number of ring slots per running job */
+
+job *pJobs = NULL;		/* Ring of jobs, in the order they were started */
+int nJobSlots = 0;		/* Size of that ring */
+int iFirstJob = 0;		/* Index of the oldest job not displayed yet */
+int nJobsQueued = 0;		/* Number of jobs not displayed yet */
+int nJobsRunning = 0;		/* Number of jobs whose output is not complete */
+struct pollfd *pPollFds;	/* The pipes of the running jobs */
+int *piPollJobs;		/* The index of their jobs in the ring */
+
+/* Append data to the output of a job */
+static void JobWrite(job *pJob, const char *pData, size_t nData) {
+  if ((pJob->nBuf + nData) > pJob->lBuf) {
+    size_t lBuf = pJob->lBuf ? pJob->lBuf : 4096;
+    char *pBuf;
+    while ((pJob->nBuf + nData) > lBuf) lBuf *= 2;
+    pBuf = realloc(pJob->pBuf, lBuf);
+    if (!pBuf) finis(RETCODE_NO_MEMORY, "Out of memory for the output of jobs");
+    pJob->pBuf = pBuf;
+    pJob->lBuf = lBuf;
+  }
+  memcpy(pJob->pBuf + pJob->nBuf, pData, nData);
+  pJob->nBuf += nData;
+}
+
+/* Wait for output from the running jobs, then display those that are complete */
+static void PollJobs(void) {
+  struct pollfd *pfds = pPollFds;
+  int *piJobs = piPollJobs;
+  int i, n = 0;
+
+  for (i=0; i<nJobsQueued; i++) {
+    int iJob = (iFirstJob + i) % nJobSlots;
+    if (pJobs[iJob].fd == -1) continue;
+    pfds[n].fd = pJobs[iJob].fd;
+    pfds[n].events = POLLIN;
+    pfds[n].revents = 0;
+    piJobs[n++] = iJob;
+  }
+  if (n && (poll(pfds, n, -1) < 0)) n = 0; /* Interrupted. Try again later */
+  for (i=0; i<n; i++) {
+    job *pJob = pJobs + piJobs[i];
+    char buf[4096];
+    ssize_t nRead;
+    if (!pfds[i].revents) continue;
+    nRead = read(pJob->fd, buf, sizeof(buf));
+    if (nRead > 0) {
+      JobWrite(pJob, buf, (size_t)nRead);
+      continue;
+    }
+    if ((nRead < 0) && (errno == EINTR)) continue;
+    close(pJob->fd);		/* End of its output */
+    pJob->fd = -1;
+    waitpid(pJob->pid, &pJob->iStatus, 0);
+    pJob->pid = 0;
+    nJobsRunning -= 1;
+  }
+
+  /* Display the complete jobs, in the order they were started */
+  while (nJobsQueued && (pJobs[iFirstJob].fd == -1)) {
+    job *pJob = pJobs + iFirstJob;
+    fflush(stdout);
+    if (pJob->nBuf) fwrite(pJob->pBuf, 1, pJob->nBuf, stdout);
+    if (pJob->iStatus) printf("\nredo: %s returns error # %d.\n", pJob->pszCmd, pJob->iStatus);
+    fflush(stdout);
+    free(pJob->pBuf);
+    free(pJob->pszCmd);
+    iFirstJob = (iFirstJob + 1) % nJobSlots;
+    nJobsQueued -= 1;
+  }
+}
+
+void StartJob(char *path, char **argv) {
+  job *pJob;
+  int fds[2];
+  int i;
+
+  if (!pJobs) {
+    nJobSlots = nJobs * JOBS_PER_RUNNING;
+    pJobs = calloc(nJobSlots, sizeof(job));
+    pPollFds = malloc(nJobs * sizeof(struct pollfd));
+    piPollJobs = malloc(nJobs * sizeof(int));
+    if (!pJobs || !pPollFds || !piPollJobs) finis(RETCODE_NO_MEMORY, "Out of memory for jobs");
+  }
+  while ((nJobsRunning == nJobs) || (nJobsQueued == nJobSlots)) PollJobs();
+
+  pJob = pJobs + ((iFirstJob + nJobsQueued) % nJobSlots);
+  memset(pJob, 0, sizeof(job));
+  pJob->pszCmd = strdup(argv[0]);
+  if (!pJob->pszCmd) finis(RETCODE_NO_MEMORY, "Out of memory for jobs");
+  if (iVerbose) { /* Display the command in front of its output */
+    JobWrite(pJob, "[", 1);
+    JobWrite(pJob, path, strlen(path));
+    JobWrite(pJob, "]", 1);
+    for (i=0; argv[i]; i++) {
+      JobWrite(pJob, argv[i], strlen(argv[i]));
+      JobWrite(pJob, " ", 1);
+    }
+    JobWrite(pJob, "\n", 1);
+  }
+
+  if (pipe(fds)) finis(RETCODE_EXEC_ERROR, "Cannot create a pipe");
+  _flushall();	/* Don't let the child inherit pending output */
+  pJob->pid = fork();
+  if (pJob->pid < 0) finis(RETCODE_EXEC_ERROR, "Cannot execute the command");
+  if (pJob->pid == 0) {		// We're the child instance
+    close(fds[0]);
+    dup2(fds[1], 1);
+    dup2(fds[1], 2);
+    close(fds[1]);
+    if (chdir(path)) {
+      fprintf(stderr, "Error: Cannot access directory %s\n", path);
+      exit(255);
+    }
+    execvp(argv[0], argv);
+    // We only get here if the exec fails
+    fprintf(stderr, "Error: Failed to run %s\n", argv[0]);
+    exit(255);
+  }
+  close(fds[1]);		// We're the parent instance
+  pJob->fd = fds[0];
+  nJobsQueued += 1;
+  nJobsRunning += 1;
+}
+
+void WaitJobs(void) {
+  while (nJobsQueued) PollJobs();
+}
+
+#endif /* HAS_JOBS */
+
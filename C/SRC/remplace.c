@@ -160,6 +160,26 @@
 *    2022-10-16 JFL Removed an unused variable.                               *
 *		    Version 3.2.3.					      *
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 3.2.4.		      *
+*    2026-10-18 JFL Compile the old string once, and match it on large input  *
+*		    blocks, instead of reading one character at a time.       *
+*		    Output the unchanged parts in bulk. Version 3.3.	      *
+*    2026-10-18 JFL Search plain strings with SSE2 first and last bytes       *
+*		    filtering. Flush stdout once per block, not every line.   *
+*		    Version 3.4.					      *
+*    2026-10-18 JFL Added options -e OLD NEW and -s SCRIPT, to replace        *
+*		    multiple strings in a single pass, with an Aho-Corasick   *
+*		    automaton. Version 3.5.				      *
+*    2026-10-18 JFL Replace plain strings in large files in parallel chunks.  *
+*		    Added option -j. Version 3.6.			      *
+*    2026-10-18 JFL Added option -r to replace strings in all files in a      *
+*		    directory tree in place, with options -n and -x to select *
+*		    them. Version 3.7.					      *
+*    2026-10-18 JFL When replacing strings in a file in place, first check    *
+*		    if anything changes, and if not, do not write anything.   *
+*		    Version 3.7.1.					      *
+*    2026-10-18 JFL Report a missing directory name after option -r as an     *
+*		    error. Version 3.7.2.				      *
+*    2026-10-18 JFL Removed a dead test in ReplaceParallel(). Version 3.7.3.  *
 *		    							      *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -167,8 +187,8 @@
 
 #define PROGRAM_DESCRIPTION "Replace substrings in a stream"
 #define PROGRAM_NAME    "remplace"
-#define PROGRAM_VERSION "3.2.4"
-#define PROGRAM_DATE    "2022-10-19"
+#define PROGRAM_VERSION "3.7.3"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -187,6 +207,7 @@
 /* SysToolsLib include files */
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
+#include "parfilter.h"	/* SysLib parallel file filtering routines */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 #define SZ 255               /* Strings size */
@@ -241,6 +262,9 @@ DEBUG_GLOBALS			/* Define global variables used by our debugging macros */
 #define FPutC FOutC1
 #define FSeek FSeek1
 #define FWrite FWrite1
+#define FRead FRead1
+
+#define BLOCK_SIZE 0x4000U	/* Size of the input blocks read. Keep it in a segment */
 
 #endif /* defined(_MSDOS) */
 
@@ -280,6 +304,22 @@ DEBUG_GLOBALS			/* Define global variables used by our debugging macros */
 
 /********************** End of OS-specific definitions ***********************/
 
+/* SSE2 is available on all x86_64 processors, and on most recent x86 ones */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+static int CTZ(unsigned int u) { /* Count trailing zeros. u must not be 0 */
+  unsigned long ul;
+  _BitScanForward(&ul, u);
+  return (int)ul;
+}
+#else
+#define CTZ(u) __builtin_ctz(u)
+#endif
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(disable:4001) /* Ignore the "nonstandard extension 'single line comment' was used" warning */
 #endif
@@ -301,6 +341,54 @@ void fail(char *pszFormat, ...) {
 
 int iVerbose = FALSE;
 FILE *mf;			    /* Message output file */
+int nThreads = 0;		    /* Number of threads for large files. 0 = Automatic */
+
+/* A compiled old string element */
+typedef struct {
+  char bMatch[256];		    /* bMatch[c] = TRUE if character c matches */
+  char cRepeat;			    /* '?', '+', '*', NUL, or \xFF if no regexp */
+} RXELEM;
+
+/* A pair of strings, for multiple replacements */
+typedef struct {
+  char *pszOld;			    /* The old string argument */
+  char *pNew;			    /* The new string, with \ escapes converted */
+  int nNew;			    /* Its size */
+  char *pOld;			    /* The compiled old string */
+  int nOld;			    /* Its size */
+  char *pMerged;		    /* The new string, with \0 and \\ merged */
+  int nMerged;			    /* Its size */
+} RULE;
+
+/* An Aho-Corasick automaton for multiple plain strings */
+typedef struct {
+  int iClass[256];		    /* Byte -> Class. 0 = Not in any old string */
+  int nClasses;			    /* Number of classes, including 0 */
+  int nStates;			    /* Number of states. 0 = Initial state */
+  int *piNext;			    /* [nStates][nClasses] transitions */
+  int *piDepth;			    /* [nStates] length of the prefix matched */
+  int *piRule;			    /* [nStates] longest old string ending there */
+  RULE *pRules;			    /* The pairs of strings */
+  char bStart[256];		    /* bStart[c] = TRUE if c leaves state 0 */
+  int nStart;			    /* Number of such bytes */
+  int cStart;			    /* If nStart == 1, that byte */
+} ACAUTO;
+
+/* Parameters for replacing plain strings in parallel chunks */
+typedef struct {
+  ACAUTO *pAC;			    /* The automaton for multiple strings, or NULL */
+  int nMaxOld;			    /* The size of its longest old string */
+  char *pLit;			    /* Else the single plain old string */
+  int nLit;			    /* Its size */
+  char *new;			    /* The new string */
+  int iNewSize;			    /* Its size */
+  RXELEM *pRx;			    /* Else the compiled old string */
+  int nRx;			    /* Its size */
+} PRPARMS;
+
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 0x100000L	    /* Size of the input blocks read */
+#endif
 
 /* Forward references */
 
@@ -319,6 +407,19 @@ int PrintEscapeChar(FILE *f, char c);
 int PrintEscapeString(FILE *f, char *pc);
 void MakeRoom(char **ppOut, int *piSize, int iNeeded);
 int MergeMatches(char *new, int iNewSize, char *match, int nMatch, char **ppOut);
+int CompileRx(char *pszOld, char cRepeat, RXELEM **ppRx);
+size_t FRead(char *pBuf, size_t lBuf, FILE *f);
+long ReplaceRx(FILE *sf, FILE *df, RXELEM *pRx, int nRx, char *new, int iNewSize);
+int GetRxLiteral(RXELEM *pRx, int nRx, char *pLit);
+char *FindLiteral(char *pBuf, size_t nBuf, char *pLit, size_t nLit);
+long ReplaceLit(FILE *sf, FILE *df, char *pLit, int nLit, char *new, int iNewSize);
+void AddRule(RULE **ppRules, int *pnRules, char *pszOld, char *pszNew);
+void ReadRules(char *pszName, RULE **ppRules, int *pnRules);
+void BuildAC(ACAUTO *pAC, RULE *pRules, int nRules, char cRepeat);
+long ReplaceAC(FILE *sf, FILE *df, ACAUTO *pAC);
+int ReplaceParallel(FILE *sf, FILE *df, PRPARMS *pParms, long *plnChanges);
+long ReplaceFile(FILE *sf, FILE *df, void *pRef);
+void ReportReplaced(const char *pszPath, long lnChanges, int iErr, void *pRef);
 int IsSameFile(char *pszPathname1, char *pszPathname2);
 int file_exists(const char *); 	/* Does this file exist? (TRUE/FALSE) */
 
@@ -370,12 +471,22 @@ int main(int argc, char *argv[]) {
   int iSetSize;		    /*  Number of valid characters in the set. */
   char cRepeat = '\0';	    /*  Repeat character. Either '?', '+', '*', or NUL. */
   int iOptionI = FALSE;	    /*  TRUE = -i option specified */
+  PRPARMS pp = {0};	    /*  Parameters for parallel replacements */
+  ACAUTO ac;		    /*  The automaton for multiple strings */
   int iEOS = FALSE;	    /*  TRUE = End Of Switches */
   char *pszPathCopy = NULL;
   char *pszDirName = NULL;  /*  Output file directory */
   char *pszOld8 = old;
   char *pszNew8 = new;
+  char *pszNewArg = NULL;   /*  The new string argument */
+  RULE *pRules = NULL;	    /*  Multiple pairs of strings */
+  int nRules = 0;
   int iErr;
+  char *pszDir = NULL;	    /*  Directory tree to process in place */
+  char **ppszInclude;	    /*  Name patterns of the files to process there */
+  char **ppszExclude;	    /*  Name patterns of the files or dirs to skip */
+  int nInclude = 0;
+  int nExclude = 0;
 
   /* Open a new message file stream for debug and verbose messages */
   if (is_redirected(stdout)) {	/* If stdout is redirected to a file or a pipe */
@@ -394,6 +505,10 @@ int main(int argc, char *argv[]) {
 
   /* Process arguments */
 
+  ppszInclude = calloc(argc, sizeof(char *));
+  ppszExclude = calloc(argc, sizeof(char *));
+  if ((!ppszInclude) || (!ppszExclude)) goto fail_no_mem;
+
   for (i=1; i<argc; i++) {
     char *pszArg = argv[i];
     if ((!iEOS) && IsSwitch(pszArg)) {          /* Process switches first */
@@ -441,6 +556,15 @@ int main(int argc, char *argv[]) {
 	continue;
       }
 #endif
+      if (strieq(pszOpt, "e")) {		/* One more pair of strings */
+	if (((i+2) >= argc) || (oldDone && !newDone)) usage(2);
+	if ((!nRules) && old[0]) AddRule(&pRules, &nRules, old, pszNewArg); /* Keep it first */
+	AddRule(&pRules, &nRules, argv[i+1], argv[i+2]);
+	i += 2;
+	oldDone = TRUE;
+	newDone = TRUE;
+	continue;
+      }
       if (strieq(pszOpt, "f")) {		/* Fixed string <==> no regexp */
 	cRepeat = '\xFF';
 	continue;
@@ -454,6 +578,14 @@ fail_no_mem:
 	iOptionI = TRUE;
 	continue;
       }
+      if (streq(pszOpt, "j")) {		/* Number of threads */
+	if ((i+1) < argc) nThreads = atoi(argv[++i]);
+	continue;
+      }
+      if (streq(pszOpt, "n") && ((i+1) < argc)) { /* Name pattern to include */
+	ppszInclude[nInclude++] = argv[++i];
+	continue;
+      }
       if (strieq(pszOpt, "nb")) {
 	iBackup = FALSE;
 	continue;
@@ -467,12 +599,25 @@ fail_no_mem:
 	iQuiet = TRUE;
 	continue;
       }
+      if (streq(pszOpt, "r")) { /* Recursive batch mode */
+	if ((i+1) >= argc) fail("Option -r needs a directory name");
+	pszDir = argv[++i];
+	continue;
+      }
       if (   streq(pszOpt, "=")
 	  || strieq(pszOpt, "same")
 	  || strieq(pszOpt, "-same")) {
 	iSameFile = TRUE;
 	continue;
       }
+      if (strieq(pszOpt, "s")) {		/* Pairs of strings in a script file */
+	if (((i+1) >= argc) || (oldDone && !newDone)) usage(2);
+	if ((!nRules) && old[0]) AddRule(&pRules, &nRules, old, pszNewArg); /* Keep it first */
+	ReadRules(argv[++i], &pRules, &nRules);
+	oldDone = TRUE;
+	newDone = TRUE;
+	continue;
+      }
       if (strieq(pszOpt, "st")) {
 	iCopyTime = TRUE;
 	continue;
@@ -485,6 +630,10 @@ fail_no_mem:
 	puts(DETAILED_VERSION);
 	exit(0);
       }
+      if (streq(pszOpt, "x") && ((i+1) < argc)) { /* Name pattern to exclude */
+	ppszExclude[nExclude++] = argv[++i];
+	continue;
+      }
       /* Default: Assume it's not a switch, but a string to replace */
     }
     if (!oldDone) {
@@ -494,6 +643,7 @@ fail_no_mem:
     }
     if (!newDone) {
       iNewSize = GetEscChars(new, pszArg, sizeof(new));
+      pszNewArg = pszArg;
       newDone = TRUE;
       continue;
     }
@@ -520,6 +670,41 @@ fail_no_mem:
     }
   )
 
+  if (pszDir) {		/* Replace strings in all matching files in a directory tree */
+    fdt_opts fdtOpts = {0};
+    if (pszInName) fail("Option -r cannot be used with file names");
+    if (iOptionI) fail("Option -r cannot be used with option -i");
+    if (demime || !(nRules || old[0])) fail("Option -r needs strings to replace");
+    if (nRules) {
+      BuildAC(&ac, pRules, nRules, cRepeat);
+      pp.pAC = &ac;
+    } else {
+      pp.nRx = CompileRx(old, cRepeat, &pp.pRx);
+      if (!pp.nRx) goto fail_no_mem;
+      if (GetRxLiteral(pp.pRx, pp.nRx, cSet)) { /* A plain string. Use the fast search. */
+	pp.pLit = cSet;
+	pp.nLit = pp.nRx;
+      }
+      pp.new = new;
+      pp.iNewSize = iNewSize;
+    }
+    fdtOpts.iFlags = (iBackup ? FF_BACKUP : 0) | (iCopyTime ? FF_SAMETIME : 0);
+    fdtOpts.nThreads = nThreads;
+    if (nInclude) fdtOpts.ppszInclude = ppszInclude;
+    if (nExclude) fdtOpts.ppszExclude = ppszExclude;
+    fdtOpts.pFilterCB = ReplaceFile;
+    fdtOpts.pReportCB = ReportReplaced;
+    fdtOpts.pRef = &pp;
+    iErr = FilterDirTree(pszDir, &fdtOpts);
+    if (iErr == -1) return 2;	/* The error has already been reported */
+    if (!iQuiet) {
+      fprintf(mf, "%ld files scanned, %ld files changed, %ld changes done\n",
+	      fdtOpts.nFiles, fdtOpts.nChanged, fdtOpts.lnChanges);
+    }
+    if (iErr) return 2;
+    return ((fdtOpts.lnChanges>0) ? 0 : 1);
+  }
+
   /* Force stdin and stdout to untranslated */
 #if defined(_MSDOS) || defined(_WIN32)
   _setmode( _fileno( stdin ), _O_BINARY );
@@ -550,6 +735,94 @@ fail_no_mem:
     iSameFile = IsSameFile(pszInName, pszOutName);
     if (iBackup && !file_exists(pszOutName)) iBackup = FALSE; /* There's nothing to backup */
   }
+  /* Identify the input encoding, and change the arguments encoding to match it */
+#ifdef _WIN32
+  {
+    UINT inputCP = consoleCodePage;
+    int err;
+    DWORD dwBOM = 0;
+    struct stat buf;			/* Use MSC 6.0 compatible names */
+    int h = fileno(sf);			/* Get the file handle */
+    int nc = 0;
+    err = fstat(h, &buf);		/* Get information on that handle */
+    if (err) fail("Can't stat the input file.\n");
+    if (buf.st_mode & S_IFREG) {	/* It's a regular file */
+      for (nc=0; nc<3; nc++) {
+        int c1 = FGetC(sf);
+        if (c1 == EOF) break;
+        ((BYTE *)&dwBOM)[nc] = (BYTE)c1;
+      }
+      if (dwBOM == 0xBFBBEF) {		/* If this is an UTF-8 BOM */
+      	inputCP = CP_UTF8;
+      } else {
+	if ((dwBOM & 0xFFFF) == 0xFEFF) { /* If this is an UTF-16 BOM */
+	  fail("UTF-16 files are not supported.\n");
+      	}
+      	inputCP = CP_ACP;
+      }
+    }
+    FSeek(sf, -nc, SEEK_CUR); /* Return to the beginning of the input file */
+    DEBUG_FPRINTF((mf, "// The input encoding is #%d\n", inputCP));
+    /* Now we need to convert the old and new strings to the input encoding */
+    pszOld8 = strdup(old);
+    pszNew8 = strdup(new);
+    ConvertString(old, sizeof(old), CP_UTF8, inputCP);
+    ConvertString(new, sizeof(new), CP_UTF8, inputCP);
+    iNewSize = (int)strlen(new);
+    for (i=0; i<nRules; i++) { /* The conversion from UTF-8 cannot make them longer */
+      ConvertString(pRules[i].pszOld, strlen(pRules[i].pszOld)+1, CP_UTF8, inputCP);
+      ConvertString(pRules[i].pNew, pRules[i].nNew+1, CP_UTF8, inputCP);
+      pRules[i].nNew = (int)strlen(pRules[i].pNew);
+    }
+  }
+#endif
+
+  if (iVerbose) {
+    if (demime && !iQuiet) fprintf(mf, "// Replacing Mime %cXX codes.\n", demime);
+    if (old[0] && !iQuiet) {
+      fprintf(mf, "// Replacing \"%s\" (\"", pszOld8); /* Use the UTF-8 version in Windows */
+      PrintEscapeString(mf, old);
+      fprintf(mf, "\") with \"%s\" (\"", pszNew8); /* Use the UTF-8 version in Windows */
+      PrintEscapeString(mf, new);
+      fprintf(mf, "\").\n");
+    }
+    for (i=(old[0] ? 1 : 0); (i<nRules) && !iQuiet; i++) {
+      fprintf(mf, "// Replacing \"");
+      PrintEscapeString(mf, pRules[i].pszOld);
+      fprintf(mf, "\" with \"");
+      PrintEscapeString(mf, pRules[i].pNew);
+      fprintf(mf, "\".\n");
+    }
+  }
+
+  /* Prepare the matchers for the old strings */
+  if (nRules && !demime) {	/* Replace all pairs in a single pass */
+    BuildAC(&ac, pRules, nRules, cRepeat);
+    DEBUG_FPRINTF((mf, "// %d pairs of strings. The automaton has %d states and %d byte classes.\n", nRules, ac.nStates, ac.nClasses));
+    pp.pAC = &ac;
+  } else if (old[0] && !demime) { /* Use the compiled matcher on large input blocks */
+    pp.nRx = CompileRx(old, cRepeat, &pp.pRx);
+    if (!pp.nRx) goto fail_no_mem;
+    if (GetRxLiteral(pp.pRx, pp.nRx, cSet)) { /* A plain string. Use the fast search. */
+      pp.pLit = cSet;
+      pp.nLit = pp.nRx;
+    }
+    pp.new = new;
+    pp.iNewSize = iNewSize;
+  }
+
+  if (iSameFile && (pp.pAC || pp.pRx) && !iOptionI) {
+    /* First check if anything changes, without writing anything */
+    if (!ReplaceParallel(sf, NULL, &pp, &lnChanges)) lnChanges = ReplaceFile(sf, NULL, &pp);
+    if (lnChanges < 0) fail("Failed to read file %s. %s\n", pszInName, strerror(errno));
+    if (!lnChanges) {		/* Then leave the file untouched */
+      fclose(sf);
+      goto report_changes;
+    }
+    rewind(sf);			/* It does change. Replace the strings for good */
+    lnChanges = 0;
+  }
+
   if (iSameFile || iBackup) { /* Then write to a temporary file */
     int iFile;
     /* But do as if we were writing directly to the target file.
@@ -601,54 +874,22 @@ open_df_failed:
     }
   }
 
-  /* Identify the input encoding, and change the arguments encoding to match it */
-#ifdef _WIN32
-  {
-    UINT inputCP = consoleCodePage;
-    int err;
-    DWORD dwBOM = 0;
-    struct stat buf;			/* Use MSC 6.0 compatible names */
-    int h = fileno(sf);			/* Get the file handle */
-    int nc = 0;
-    err = fstat(h, &buf);		/* Get information on that handle */
-    if (err) fail("Can't stat the input file.\n");
-    if (buf.st_mode & S_IFREG) {	/* It's a regular file */
-      for (nc=0; nc<3; nc++) {
-        int c1 = FGetC(sf);
-        if (c1 == EOF) break;
-        ((BYTE *)&dwBOM)[nc] = (BYTE)c1;
-      }
-      if (dwBOM == 0xBFBBEF) {		/* If this is an UTF-8 BOM */
-      	inputCP = CP_UTF8;
-      } else {
-	if ((dwBOM & 0xFFFF) == 0xFEFF) { /* If this is an UTF-16 BOM */
-	  fail("UTF-16 files are not supported.\n");
-      	}
-      	inputCP = CP_ACP;
-      }
-    }
-    FSeek(sf, -nc, SEEK_CUR); /* Return to the beginning of the input file */
-    DEBUG_FPRINTF((mf, "// The input encoding is #%d\n", inputCP));
-    /* Now we need to convert the old and new strings to the input encoding */
-    pszOld8 = strdup(old);
-    pszNew8 = strdup(new);
-    ConvertString(old, sizeof(old), CP_UTF8, inputCP);
-    ConvertString(new, sizeof(new), CP_UTF8, inputCP);
-    iNewSize = (int)strlen(new);
+  if (pp.pAC) {
+    if (!ReplaceParallel(sf, df, &pp, &lnChanges)) lnChanges = ReplaceAC(sf, df, pp.pAC);
+    goto close_files;
   }
-#endif
 
-  if (iVerbose) {
-    if (demime && !iQuiet) fprintf(mf, "// Replacing Mime %cXX codes.\n", demime);
-    if (old[0] && !iQuiet) {
-      fprintf(mf, "// Replacing \"%s\" (\"", pszOld8); /* Use the UTF-8 version in Windows */
-      PrintEscapeString(mf, old);
-      fprintf(mf, "\") with \"%s\" (\"", pszNew8); /* Use the UTF-8 version in Windows */
-      PrintEscapeString(mf, new);
-      fprintf(mf, "\").\n");
+  if (pp.pRx) {
+    if (pp.pLit) {
+      if (!ReplaceParallel(sf, df, &pp, &lnChanges)) lnChanges = ReplaceLit(sf, df, pp.pLit, pp.nLit, new, iNewSize);
+    } else {
+      lnChanges = ReplaceRx(sf, df, pp.pRx, pp.nRx, new, iNewSize);
     }
+    free(pp.pRx);
+    goto close_files;
   }
 
+  /* Else demime, or process the degenerate empty old string, one char at a time */
   ixOld = 0;
   ixOld += GetRxCharSet(old+ixOld, cSet, &iSetSize, &cRepeat);
   ixMaybe = 0;
@@ -768,6 +1009,7 @@ try_next_set:
     FWrite(maybe, ixMaybe, 1, df); /* Flush an uncompleted old string */
   }
 
+close_files:
   if (sf != stdin) fclose(sf);
   if (df != stdout) fclose(df);
   DEBUG_FPRINTF((mf, "// Writing done\n"));
@@ -823,6 +1065,7 @@ try_next_set:
     }
   }
 
+report_changes:
   if (iVerbose) fprintf(mf, "// Remplace: %ld changes done.\n", lnChanges);
 
   return ((lnChanges>0) ? 0 : 1);              /* and exit */
@@ -888,16 +1131,25 @@ PROGRAM_NAME_AND_VERSION " - " PROGRAM_DESCRIPTION "\n\
 \n\
 Usage: remplace [SWITCHES] OPERATIONS [FILES_SPEC]\n\
 \n\
-files_spec: [INFILE [OUTFILE|-same]]\n\
+files_spec: [INFILE [OUTFILE|-same]]|-r DIRECTORY\n\
   INFILE   Input file pathname. Default or \"-\": stdin\n\
-  OUTFILE  Output file pathname. Default or \"-\": stdout\n");
+  OUTFILE  Output file pathname. Default or \"-\": stdout\n\
+  -r DIR   Process in place all files in this directory tree, then list totals\n\
+           Not supported with -@, -%%, -. or -i\n");
     fprintf(f, "%s", "\
 \n\
-operation: {old_string new_string}|-@|-%|-.\n\
+operation: {old_string new_string}|-e OLD NEW|-s SCRIPT|-@|-%|-.\n\
+  -e OLD NEW  Replace OLD by NEW too. Can be repeated.\n\
+  -s SCRIPT   Replace the pairs of strings listed in file SCRIPT.\n\
+              One \"old\" \"new\" pair per line. Lines beginning with a # ignored.\n\
   -@       Decode Mime =XX codes.\n\
   -%       Decode URL %XX codes.\n\
   -.       No change.\n\
 \n\
+With multiple pairs, all are replaced in a single pass. The leftmost match\n\
+is replaced first, and the longest one if several begin at the same place.\n\
+Multiple old strings must be plain strings, without regular expressions.\n\
+\n\
 Note that the input is byte-oriented, not line oriented. So both the old\n\
 string and new string can span multiple lines.\n\
 \n\
@@ -913,11 +1165,15 @@ switches:\n\
 "\
   -f       Fixed old string = Disable the regular expression subset supported.\n\
   -i TEXT  Input text to use before input file, if any. (Use - for force stdin)\n\
+  -j N     Process large files using N threads. Default: 1 per CPU. 1=Serial\n\
+           With -r, process N files at a time\n\
+  -n NAME  With -r, process only files matching this wildcard name. Repeatable\n\
   -q       Quiet mode. No status message.\n\
   -=|-same Modify the input file in place. (Default: Automatically detected)\n\
   -st      Set the output file time to the same time as the input file.\n\
-  -v       Verbose mode.\n\
+  -v       Verbose mode. With -r, list the files changed.\n\
   -V       Display this program version\n\
+  -x NAME  With -r, skip files and dirs matching this wildcard. Repeatable\n\
 \n\
 Examples:\n"
 );
@@ -1483,6 +1739,976 @@ int MergeMatches(char *new, int iNewSize, char *match, int nMatch, char **ppOut)
   return ixOut;
 }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    CompileRx	         				      |
+|									      |
+|   Description:    Compile the old string into an array of elements	      |
+|									      |
+|   Parameters:     char *pszOld	The old string			      |
+|		    char cRepeat	NUL, or \xFF to disable regexps	      |
+|		    RXELEM **ppRx	Where to store the array address      |
+|									      |
+|   Returns:	    The number of elements, or 0 if out of memory.	      |
+|									      |
+|   Notes:	    Parse the old string with GetRxCharSet() exactly as the   |
+|		    character-by-character loop in main() does, but only once.|
+|		    The sets are converted to 256-byte lookup tables.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int CompileRx(char *pszOld, char cRepeat, RXELEM **ppRx) {
+  RXELEM *pRx = NULL;
+  int nRx = 0;
+  int ixOld = 0;
+  char cSet[256];
+  int iSetSize;
+  int i;
+
+  do {
+    RXELEM *pRx2 = realloc(pRx, (nRx + 1) * sizeof(RXELEM));
+    if (!pRx2) {
+      free(pRx);
+      return 0;
+    }
+    pRx = pRx2;
+    ixOld += GetRxCharSet(pszOld+ixOld, cSet, &iSetSize, &cRepeat);
+    memset(pRx[nRx].bMatch, 0, 256);
+    for (i=0; i<iSetSize; i++) pRx[nRx].bMatch[(unsigned char)cSet[i]] = TRUE;
+    pRx[nRx++].cRepeat = cRepeat;
+  } while (pszOld[ixOld]);
+
+  *ppRx = pRx;
+  return nRx;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    FRead	         				      |
+|									      |
+|   Description:    Read a block of data from a file stream		      |
+|									      |
+|   Parameters:     char *pBuf		    Where to store the data	      |
+|		    size_t lBuf		    The buffer size		      |
+|		    FILE *f		    The stream handle		      |
+|									      |
+|   Returns:	    The number of bytes read. 0 = End of file or error.       |
+|									      |
+|   Notes:	    This is a front end to the standard C library fread().    |
+|		    Characters pending in the FGetC() back buffer, like the   |
+|		    -i input string, are returned first.		      |
+|		    For pipes and consoles, return whatever data is available,|
+|		    instead of waiting for the whole buffer to be filled.     |
+|		    This preserves the real time output in long complex cmds. |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+size_t FRead(char *pBuf, size_t lBuf, FILE *f) {
+  size_t n = 0;
+  struct stat st;
+  int iRead;
+
+  while (ixBB && (n < lBuf)) pBuf[n++] = (char)FGetC(f);
+  if (n) return n;
+
+  if (fstat(fileno(f), &st) || S_ISREG(st.st_mode)) return fread(pBuf, 1, lBuf, f);
+
+  /* Pipes and consoles. Nothing was read by stdio from these, so bypass its buffer */
+  if (lBuf > 0x40000000) lBuf = 0x40000000;
+  do {
+    iRead = (int)read(fileno(f), pBuf, (unsigned int)lBuf);
+  } while ((iRead == -1) && (errno == EINTR));
+  return (iRead > 0) ? (size_t)iRead : 0;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReplaceRx	         				      |
+|									      |
+|   Description:    Copy a stream, replacing the compiled old string	      |
+|									      |
+|   Parameters:     FILE *sf		The input stream		      |
+|		    FILE *df		The output stream, or NULL	      |
+|		    RXELEM *pRx		The compiled old string		      |
+|		    int nRx		Its number of elements		      |
+|		    char *new		The new string			      |
+|		    int iNewSize	Its size			      |
+|									      |
+|   Returns:	    The number of changes done				      |
+|									      |
+|   Notes:	    This is the same state machine as the character-by-       |
+|		    character loop in main(), with exactly the same results:  |
+|		    Repetitions are greedy, and after a partial match, the    |
+|		    search restarts on the next character.		      |
+|		    But it works on large blocks of input data, so that the   |
+|		    backtracking is just a move of an index in the block.     |
+|		    Outside of matches, skip in bulk all the characters that  |
+|		    cannot begin one, and write them unchanged in one call.   |
+|		    Output to stdout is flushed before reading each block,    |
+|		    instead of after every line.			      |
+|		    If df is NULL, write nothing, and return at the first     |
+|		    change. This checks if a file needs to be changed.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long ReplaceRx(FILE *sf, FILE *df, RXELEM *pRx, int nRx, char *new, int iNewSize) {
+  char *pBuf;			/* Input data block */
+  size_t lBuf = BLOCK_SIZE;	/* Its allocated size */
+  size_t nBuf = 0;		/* Number of bytes in the block */
+  size_t ix = 0;		/* Index of the next byte to process */
+  size_t ixOut = 0;		/* Index of the first byte not yet output */
+  size_t ixMatch = 0;		/* Index of the first byte of the current match */
+  size_t nMatch = 0;		/* Number of bytes matched so far */
+  int iRx = 0;			/* Index of the current element */
+  char cRepeat = pRx[0].cRepeat;/* Its repetition, as updated by the matches */
+  char bStart[256];		/* bStart[c] = TRUE if c can begin a match */
+  int nStart = 0;		/* Number of characters that can begin a match */
+  int cStart = 0;		/* If nStart == 1, that character */
+  int iSkip = FALSE;		/* TRUE if non-matching characters can be skipped */
+  int iMerge = (memchr(new, '\\', iNewSize) != NULL); /* TRUE if new has \0 or \\ */
+  long lnChanges = 0;
+  int c;
+  int i;
+
+  /* A character that does not belong to any set up to the first mandatory
+     element leaves the machine in its initial state, and is output as is. */
+  memset(bStart, 0, sizeof(bStart));
+  for (i=0; i<nRx; i++) {
+    for (c=0; c<256; c++) if (pRx[i].bMatch[c]) bStart[c] = TRUE;
+    if ((pRx[i].cRepeat != '?') && (pRx[i].cRepeat != '*')) {
+      iSkip = TRUE;
+      break;
+    } /* Else all elements are optional, and any character may cause a change */
+  }
+  for (c=0; c<256; c++) if (bStart[c]) {
+    nStart += 1;
+    cStart = c;
+  }
+
+  pBuf = malloc(lBuf);
+  if (!pBuf) FAIL("Not enough memory");
+
+#define EMIT_NEW() do { /* Output what precedes the match, then the new string */ \
+    if (!nMatch) ixMatch = ix;						\
+    if (df && (ixMatch > ixOut)) fwrite(pBuf+ixOut, 1, ixMatch-ixOut, df); \
+    if (df && iMerge) {							\
+      char *new2;							\
+      int iNewSize2 = MergeMatches(new, iNewSize, pBuf+ixMatch, (int)nMatch, &new2); \
+      fwrite(new2, 1, iNewSize2, df);					\
+      free(new2);							\
+    } else if (df && iNewSize) {					\
+      fwrite(new, 1, iNewSize, df);					\
+    }									\
+    ixOut = ixMatch + nMatch;						\
+    nMatch = 0;								\
+    lnChanges += 1;							\
+  } while (0)
+
+  while (1) {
+    if (lnChanges && !df) break; /* Check mode, and the stream changes */
+    if (ix == nBuf) {		/* Get more data */
+      size_t ixKeep = nMatch ? ixMatch : ix;
+      size_t nRead;
+      /* Output what's done, and move the pending match to the head */
+      if (df && (ixKeep > ixOut)) fwrite(pBuf+ixOut, 1, ixKeep-ixOut, df);
+      if (df == stdout) fflush(df); /* Flush the output before waiting for input */
+      if (ixKeep) memmove(pBuf, pBuf+ixKeep, nBuf-ixKeep);
+      nBuf -= ixKeep;
+      ix -= ixKeep;
+      ixMatch -= nMatch ? ixKeep : ixMatch;
+      ixOut = 0;
+      if (nBuf == lBuf) {	/* The match is as long as the block */
+	char *pBuf2 = realloc(pBuf, lBuf * 2);
+	if (!pBuf2) FAIL("Not enough memory");
+	pBuf = pBuf2;
+	lBuf *= 2;
+      }
+      nRead = FRead(pBuf+nBuf, lBuf-nBuf, sf);
+      if (!nRead) break;	/* End of file */
+      nBuf += nRead;
+    }
+
+    if (iSkip && !iRx && !nMatch) { /* In the initial state. Skip non-matching characters */
+      if (nStart == 1) {
+	char *pc = memchr(pBuf+ix, cStart, nBuf-ix);
+	ix = pc ? (size_t)(pc-pBuf) : nBuf;
+      } else {
+	while ((ix < nBuf) && !bStart[(unsigned char)pBuf[ix]]) ix++;
+      }
+      if (ix == nBuf) continue;
+    }
+
+    c = (unsigned char)pBuf[ix];
+try_next_set:
+    if (pRx[iRx].bMatch[c]) {	/* If c belongs to the old string */
+      if (!nMatch) ixMatch = ix;
+      nMatch += 1;
+      ix += 1;
+      if (cRepeat == '?') cRepeat = '\0'; /* We've found it. No more expected. */
+      if (cRepeat == '+') cRepeat = '*';  /* We've found it. More possible. */
+      if (cRepeat == '*') continue;
+      if (iRx == (nRx-1)) {		  /* If this was the last element */
+	EMIT_NEW();
+	iRx = -1;			  /* and start over again. */
+      }
+    } else {			/* Else it is an unexpected char. */
+      if ((cRepeat == '?') || (cRepeat == '*')) {
+	if (iRx < (nRx-1)) {
+	  cRepeat = pRx[++iRx].cRepeat;
+	  goto try_next_set;
+	}
+	EMIT_NEW();		/* The set was complete. Write the new string */
+      }
+      if (nMatch) {		/* If there were pending characters */
+	ix = ixMatch + 1;	/* Output 1 character only, and retry on the next */
+	nMatch = 0;
+      } else {
+	ix += 1;		/* Output the given character */
+      }
+      iRx = -1;
+    }
+    cRepeat = pRx[++iRx].cRepeat;
+  }
+  DEBUG_FPRINTF((mf, "// End of file. Flushing remainders.\n"));
+  if (((cRepeat == '?') || (cRepeat == '*')) && (iRx == (nRx-1))) {
+    EMIT_NEW();			/* The set was complete. Write the new string */
+  }
+  if (df && (nBuf > ixOut)) fwrite(pBuf+ixOut, 1, nBuf-ixOut, df); /* Flush an uncompleted old string */
+#undef EMIT_NEW
+
+  free(pBuf);
+  return lnChanges;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    GetRxLiteral	         			      |
+|									      |
+|   Description:    Check if a compiled old string is a plain byte string     |
+|									      |
+|   Parameters:     RXELEM *pRx		The compiled old string		      |
+|		    int nRx		Its number of elements		      |
+|		    char *pLit		Where to store the string. nRx bytes. |
+|									      |
+|   Returns:	    TRUE if it is, with the bytes stored in pLit	      |
+|									      |
+|   Notes:	    This is the case with option -f, and for regular	      |
+|		    expressions without sets nor repetitions.		      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int GetRxLiteral(RXELEM *pRx, int nRx, char *pLit) {
+  int i, c, n;
+
+  for (i=0; i<nRx; i++) {
+    if (pRx[i].cRepeat && (pRx[i].cRepeat != '\xFF')) return FALSE;
+    for (c=0, n=0; c<256; c++) if (pRx[i].bMatch[c]) {
+      if (n++) return FALSE;
+      pLit[i] = (char)c;
+    }
+    if (!n) return FALSE;
+  }
+  return TRUE;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    FindLiteral	         				      |
+|									      |
+|   Description:    Search a byte string in a buffer			      |
+|									      |
+|   Parameters:     char *pBuf		The buffer to search		      |
+|		    size_t nBuf		Its size			      |
+|		    char *pLit		The byte string to look for	      |
+|		    size_t nLit		Its size. Must be > 0		      |
+|									      |
+|   Returns:	    The address of the first match, or NULL if none.	      |
+|									      |
+|   Notes:	    With SSE2, compare the first and the last bytes of the    |
+|		    string with 16 possible positions at a time, and only     |
+|		    compare the middle bytes for the positions where both     |
+|		    match. This filters out almost all false candidates, even |
+|		    when the first byte is frequent in the data.	      |
+|		    Without SSE2, use memchr() to locate the first byte.      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+char *FindLiteral(char *pBuf, size_t nBuf, char *pLit, size_t nLit) {
+  size_t i = 0;
+  char *pc;
+
+  if (nLit > nBuf) return NULL;
+  if (nLit == 1) return memchr(pBuf, pLit[0], nBuf);
+#if HAS_SSE2
+  {
+    __m128i vFirst = _mm_set1_epi8(pLit[0]);
+    __m128i vLast = _mm_set1_epi8(pLit[nLit-1]);
+    for ( ; (i + nLit - 1 + 16) <= nBuf; i += 16) {
+      __m128i vF = _mm_cmpeq_epi8(vFirst, _mm_loadu_si128((__m128i *)(pBuf + i)));
+      __m128i vL = _mm_cmpeq_epi8(vLast, _mm_loadu_si128((__m128i *)(pBuf + i + nLit - 1)));
+      unsigned int uMask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(vF, vL));
+      while (uMask) {
+	pc = pBuf + i + CTZ(uMask);
+	if (!memcmp(pc + 1, pLit + 1, nLit - 2)) return pc;
+	uMask &= uMask - 1;	/* Clear the lowest bit set */
+      }
+    }
+  }
+#endif
+  /* Search the end of the buffer, or all of it if there's no SSE2 */
+  while ((i + nLit) <= nBuf) {
+    pc = memchr(pBuf + i, pLit[0], nBuf - nLit + 1 - i);
+    if (!pc) break;
+    if (!memcmp(pc + 1, pLit + 1, nLit - 1)) return pc;
+    i = (size_t)(pc - pBuf) + 1;
+  }
+  return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReplaceLit	         				      |
+|									      |
+|   Description:    Copy a stream, replacing a plain byte string	      |
+|									      |
+|   Parameters:     FILE *sf		The input stream		      |
+|		    FILE *df		The output stream, or NULL	      |
+|		    char *pLit		The old byte string		      |
+|		    int nLit		Its size			      |
+|		    char *new		The new string			      |
+|		    int iNewSize	Its size			      |
+|									      |
+|   Returns:	    The number of changes done				      |
+|									      |
+|   Notes:	    For a plain string, the general state machine in	      |
+|		    ReplaceRx() is just a search for the leftmost non-	      |
+|		    overlapping occurrences. So search them with FindLiteral()|
+|		    and write the data between them with single fwrite calls. |
+|		    As all matches are identical, the \0 substitutions in the |
+|		    new string are done only once.			      |
+|		    If df is NULL, write nothing, and return at the first     |
+|		    change. This checks if a file needs to be changed.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long ReplaceLit(FILE *sf, FILE *df, char *pLit, int nLit, char *new, int iNewSize) {
+  char *pBuf;			/* Input data block */
+  size_t nBuf = 0;		/* Number of bytes in the block */
+  size_t ix;			/* Index of the first byte not yet output */
+  size_t nKeep;			/* Number of bytes kept for the next block */
+  size_t nRead;
+  char *pNew = new;		/* The new string, with \0 and \\ merged */
+  int iNewSize2 = iNewSize;
+  long lnChanges = 0;
+  char *pc;
+
+  if (memchr(new, '\\', iNewSize)) iNewSize2 = MergeMatches(new, iNewSize, pLit, nLit, &pNew);
+
+  pBuf = malloc(BLOCK_SIZE);
+  if (!pBuf) FAIL("Not enough memory");
+
+  while ((df || !lnChanges) && ((nRead = FRead(pBuf+nBuf, BLOCK_SIZE-nBuf, sf)) != 0)) {
+    nBuf += nRead;
+    for (ix = 0; (pc = FindLiteral(pBuf+ix, nBuf-ix, pLit, nLit)) != NULL; ix = (size_t)(pc-pBuf) + nLit) {
+      lnChanges += 1;
+      if (!df) break;		/* Check mode. No need to go further */
+      fwrite(pBuf+ix, 1, (size_t)(pc-pBuf) - ix, df);
+      fwrite(pNew, 1, iNewSize2, df);
+    }
+    /* The last nLit-1 bytes may be the beginning of a match. Keep them for the next block. */
+    nKeep = nBuf - ix;
+    if (nKeep > (size_t)(nLit-1)) nKeep = nLit-1;
+    if (df) fwrite(pBuf+ix, 1, nBuf-ix-nKeep, df);
+    memmove(pBuf, pBuf+nBuf-nKeep, nKeep);
+    nBuf = nKeep;
+    if (df == stdout) fflush(df); /* Flush the output before waiting for input */
+  }
+  if (df) fwrite(pBuf, 1, nBuf, df);
+
+  if (pNew != new) free(pNew);
+  free(pBuf);
+  return lnChanges;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    AddRule	         				      |
+|									      |
+|   Description:    Add a pair of strings to the list of replacements	      |
+|									      |
+|   Parameters:     RULE **ppRules	The list address		      |
+|		    int *pnRules	The number of pairs in the list	      |
+|		    char *pszOld	The old string argument		      |
+|		    char *pszNew	The new string argument		      |
+|									      |
+|   Returns:	    Nothing. Exits if not enough memory.		      |
+|									      |
+|   Notes:	    The old string is kept as is, and compiled later, like    |
+|		    the one in main(). The \ sequences in the new string are  |
+|		    converted now.					      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+void AddRule(RULE **ppRules, int *pnRules, char *pszOld, char *pszNew) {
+  RULE *pRules = realloc(*ppRules, (*pnRules + 1) * sizeof(RULE));
+  RULE *pRule;
+  size_t l = strlen(pszNew);
+
+  if (!pRules) FAIL("Not enough memory");
+  *ppRules = pRules;
+  pRule = pRules + (*pnRules)++;
+  pRule->pszOld = strdup(pszOld);
+  pRule->pNew = malloc(l+1);
+  if ((!pRule->pszOld) || (!pRule->pNew)) FAIL("Not enough memory");
+  pRule->nNew = GetEscChars(pRule->pNew, pszNew, l);
+  pRule->pNew[pRule->nNew] = '\0'; /* Convenience for the verbose output */
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReadRules	         				      |
+|									      |
+|   Description:    Read pairs of strings from a script file		      |
+|									      |
+|   Parameters:     char *pszName	The script file name		      |
+|		    RULE **ppRules	The list address		      |
+|		    int *pnRules	The number of pairs in the list	      |
+|									      |
+|   Returns:	    Nothing. Exits in case of error.			      |
+|									      |
+|   Notes:	    Each line contains an old string and a new string,	      |
+|		    separated by spaces or tabs. Strings containing spaces    |
+|		    must be quoted with "s. Use \" for a " in a quoted string.|
+|		    A missing new string is the same as "".		      |
+|		    Empty lines and lines beginning with a # are ignored.     |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+char *GetRuleToken(char **ppsz) { /* Extract the next token from a script line */
+  char *p = *ppsz;
+  char *pszToken;
+
+  while ((*p == ' ') || (*p == '\t')) p++;
+  if (!*p) return NULL;
+  if (*p == '"') {	/* A quoted string. Stop on the closing quote */
+    pszToken = ++p;
+    while (*p && (*p != '"')) {
+      if ((*p == '\\') && p[1]) p++; /* Skip escaped characters, including \" */
+      p++;
+    }
+  } else {		/* An unquoted string. Stop on the next blank */
+    pszToken = p;
+    while (*p && (*p != ' ') && (*p != '\t')) p++;
+  }
+  if (*p) *(p++) = '\0';
+  *ppsz = p;
+  return pszToken;
+}
+
+void ReadRules(char *pszName, RULE **ppRules, int *pnRules) {
+  FILE *f = fopen(pszName, "r");
+  char szLine[4096];
+  int iLine = 0;
+
+  if (!f) fail("Can't open file %s. %s\n", pszName, strerror(errno));
+  while (fgets(szLine, sizeof(szLine), f)) {
+    char *p = szLine;
+    char *pszOld, *pszNew;
+    size_t l = strlen(szLine);
+
+    iLine += 1;
+    if (l && (szLine[l-1] != '\n') && !feof(f)) fail("Line %d too long in %s\n", iLine, pszName);
+    while (l && ((szLine[l-1] == '\n') || (szLine[l-1] == '\r'))) szLine[--l] = '\0';
+    if (szLine[strspn(szLine, " \t")] == '#') continue; /* Comment line */
+    pszOld = GetRuleToken(&p);
+    if (!pszOld) continue;	/* Empty line */
+    pszNew = GetRuleToken(&p);
+    if (!pszNew) pszNew = "";
+    if (GetRuleToken(&p)) fail("Too many strings on line %d in %s\n", iLine, pszName);
+    AddRule(ppRules, pnRules, pszOld, pszNew);
+  }
+  fclose(f);
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    BuildAC	         				      |
+|									      |
+|   Description:    Build an Aho-Corasick automaton for a list of strings     |
+|									      |
+|   Parameters:     ACAUTO *pAC		The automaton to build		      |
+|		    RULE *pRules	The list of pairs of strings	      |
+|		    int nRules		The number of pairs in the list	      |
+|		    char cRepeat	NUL, or \xFF to disable regexps	      |
+|									      |
+|   Returns:	    Nothing. Exits in case of error.			      |
+|									      |
+|   Notes:	    The old strings are compiled as in the single string case,|
+|		    but they must be plain strings, without regular	      |
+|		    expressions sets or repetitions.			      |
+|		    							      |
+|		    The input bytes are first mapped to classes, with all     |
+|		    bytes absent from the old strings in class 0. This keeps  |
+|		    the transition table small.				      |
+|		    							      |
+|		    The failure links are resolved into the transition table, |
+|		    so that the scan does a single lookup per input byte.     |
+|		    Each state records the longest old string ending there.   |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+void BuildAC(ACAUTO *pAC, RULE *pRules, int nRules, char cRepeat) {
+  int iRule, i, c, iState;
+  int nMaxStates = 1;
+  int *piFail;
+  int *piQueue;
+  int nQueue, ixQueue;
+
+  memset(pAC, 0, sizeof(ACAUTO));
+  /* Compile the old strings, and merge the new strings with them */
+  for (iRule=0; iRule<nRules; iRule++) {
+    RULE *pRule = pRules + iRule;
+    RXELEM *pRx;
+    int nRx = CompileRx(pRule->pszOld, cRepeat, &pRx);
+    if (!nRx) FAIL("Not enough memory");
+    pRule->pOld = malloc(nRx);
+    if (!pRule->pOld) FAIL("Not enough memory");
+    if ((!pRule->pszOld[0]) || !GetRxLiteral(pRx, nRx, pRule->pOld)) {
+      fail("Multiple old strings must be plain strings: \"%s\"\n", pRule->pszOld);
+    }
+    free(pRx);
+    pRule->nOld = nRx;
+    pRule->pMerged = pRule->pNew;
+    pRule->nMerged = pRule->nNew;
+    if (memchr(pRule->pNew, '\\', pRule->nNew)) {
+      pRule->nMerged = MergeMatches(pRule->pNew, pRule->nNew, pRule->pOld, nRx, &(pRule->pMerged));
+    }
+    nMaxStates += nRx;
+    for (i=0; i<nRx; i++) {
+      c = (unsigned char)pRule->pOld[i];
+      if (!pAC->iClass[c]) pAC->iClass[c] = ++pAC->nClasses;
+    }
+  }
+  pAC->nClasses += 1;	/* Count class 0 */
+  pAC->pRules = pRules;
+
+  pAC->piNext = malloc(nMaxStates * pAC->nClasses * sizeof(int));
+  pAC->piDepth = malloc(nMaxStates * sizeof(int));
+  pAC->piRule = malloc(nMaxStates * sizeof(int));
+  piFail = malloc(nMaxStates * sizeof(int));
+  piQueue = malloc(nMaxStates * sizeof(int));
+  if (!pAC->piNext || !pAC->piDepth || !pAC->piRule || !piFail || !piQueue) FAIL("Not enough memory");
+
+  /* Build the trie. -1 = No transition yet */
+  memset(pAC->piNext, -1, nMaxStates * pAC->nClasses * sizeof(int));
+  pAC->nStates = 1;
+  pAC->piDepth[0] = 0;
+  pAC->piRule[0] = -1;
+  for (iRule=0; iRule<nRules; iRule++) {
+    RULE *pRule = pRules + iRule;
+    iState = 0;
+    for (i=0; i<pRule->nOld; i++) {
+      int *piNext = pAC->piNext + iState * pAC->nClasses + pAC->iClass[(unsigned char)pRule->pOld[i]];
+      if (*piNext == -1) {
+	*piNext = pAC->nStates;
+	pAC->piDepth[pAC->nStates] = i+1;
+	pAC->piRule[pAC->nStates] = -1;
+	pAC->nStates += 1;
+      }
+      iState = *piNext;
+    }
+    if (pAC->piRule[iState] == -1) pAC->piRule[iState] = iRule; /* The first duplicate wins */
+  }
+
+  /* Compute the failure links breadth first, and resolve them in the table */
+  nQueue = ixQueue = 0;
+  for (c=0; c<pAC->nClasses; c++) {
+    int *piNext = pAC->piNext + c;
+    if (*piNext == -1) {
+      *piNext = 0;
+    } else {
+      piFail[*piNext] = 0;
+      piQueue[nQueue++] = *piNext;
+    }
+  }
+  while (ixQueue < nQueue) {
+    int iFrom = piQueue[ixQueue++];
+    for (c=0; c<pAC->nClasses; c++) {
+      int *piNext = pAC->piNext + iFrom * pAC->nClasses + c;
+      int iFail = pAC->piNext[piFail[iFrom] * pAC->nClasses + c];
+      if (*piNext == -1) {
+	*piNext = iFail;
+      } else {
+	iState = *piNext;
+	piFail[iState] = iFail;
+	/* If no old string ends here, the longest one is that of the failure state */
+	if (pAC->piRule[iState] == -1) pAC->piRule[iState] = pAC->piRule[iFail];
+	piQueue[nQueue++] = iState;
+      }
+    }
+  }
+  free(piQueue);
+  free(piFail);
+
+  /* The bytes that leave the initial state */
+  for (c=0; c<256; c++) {
+    if (pAC->piNext[pAC->iClass[c]]) {
+      pAC->bStart[c] = TRUE;
+      pAC->nStart += 1;
+      pAC->cStart = c;
+    }
+  }
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReplaceAC	         				      |
+|									      |
+|   Description:    Copy a stream, replacing a list of plain strings	      |
+|									      |
+|   Parameters:     FILE *sf		The input stream		      |
+|		    FILE *df		The output stream, or NULL	      |
+|		    ACAUTO *pAC		The Aho-Corasick automaton	      |
+|									      |
+|   Returns:	    The number of changes done				      |
+|									      |
+|   Notes:	    Replace the leftmost match first, and the longest one if  |
+|		    several begin at the same place. Then continue after it.  |
+|		    							      |
+|		    A match found is only a candidate, as a longer one that   |
+|		    begins before it may still be in progress. The current    |
+|		    state depth tells where the earliest match in progress    |
+|		    begins. Once this is past the candidate, it is final.     |
+|		    Then the scan resumes right after the replaced string.    |
+|		    If df is NULL, write nothing, and return at the first     |
+|		    change. This checks if a file needs to be changed.	      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long ReplaceAC(FILE *sf, FILE *df, ACAUTO *pAC) {
+  char *pBuf;			/* Input data block */
+  size_t lBuf = BLOCK_SIZE;	/* Its allocated size */
+  size_t nBuf = 0;		/* Number of bytes in the block */
+  size_t ix = 0;		/* Index of the next byte to process */
+  size_t ixOut = 0;		/* Index of the first byte not yet output */
+  size_t ixMatch = 0;		/* Index of the candidate match */
+  int iMatch = -1;		/* Its rule, or -1 if none */
+  int iState = 0;		/* Current automaton state */
+  int iEOF = FALSE;
+  long lnChanges = 0;
+  int nClasses = pAC->nClasses;
+
+  pBuf = malloc(lBuf);
+  if (!pBuf) FAIL("Not enough memory");
+
+  while (1) {
+    int iRule;
+    size_t ixStart;
+
+    if (lnChanges && !df) break; /* Check mode, and the stream changes */
+    if (ix == nBuf) {
+      if (!iEOF) {		/* Get more data */
+	size_t ixKeep = ix - pAC->piDepth[iState]; /* Where the earliest match in progress begins */
+	size_t nRead;
+	/* Output what's done, and move the pending data to the head */
+	if (df && (ixKeep > ixOut)) fwrite(pBuf+ixOut, 1, ixKeep-ixOut, df);
+	if (df == stdout) fflush(df); /* Flush the output before waiting for input */
+	if (ixKeep) memmove(pBuf, pBuf+ixKeep, nBuf-ixKeep);
+	nBuf -= ixKeep;
+	ix -= ixKeep;
+	if (iMatch >= 0) ixMatch -= ixKeep;
+	ixOut = 0;
+	if (nBuf == lBuf) {	/* The pending data fills the block */
+	  char *pBuf2 = realloc(pBuf, lBuf * 2);
+	  if (!pBuf2) FAIL("Not enough memory");
+	  pBuf = pBuf2;
+	  lBuf *= 2;
+	}
+	nRead = FRead(pBuf+nBuf, lBuf-nBuf, sf);
+	if (nRead) {
+	  nBuf += nRead;
+	  continue;
+	}
+	iEOF = TRUE;
+      }
+      if (iMatch < 0) break;	/* End of file, and no pending match */
+      ixStart = nBuf + 1;	/* Force accepting the candidate */
+    } else {
+      if (!iState && (iMatch < 0)) { /* In the initial state. Skip non-matching bytes */
+	if (pAC->nStart == 1) {
+	  char *pc = memchr(pBuf+ix, pAC->cStart, nBuf-ix);
+	  ix = pc ? (size_t)(pc-pBuf) : nBuf;
+	} else {
+	  while ((ix < nBuf) && !pAC->bStart[(unsigned char)pBuf[ix]]) ix++;
+	}
+	if (ix == nBuf) continue;
+      }
+      iState = pAC->piNext[iState * nClasses + pAC->iClass[(unsigned char)pBuf[ix++]]];
+      iRule = pAC->piRule[iState];
+      if (iRule >= 0) {		/* The longest old string ending here */
+	size_t nOld = (size_t)pAC->pRules[iRule].nOld;
+	ixStart = ix - nOld;
+	if (   (iMatch < 0)
+	    || (ixStart < ixMatch)
+	    || ((ixStart == ixMatch) && (nOld > (size_t)pAC->pRules[iMatch].nOld))) {
+	  iMatch = iRule;
+	  ixMatch = ixStart;
+	}
+      }
+      if (iMatch < 0) continue;
+      ixStart = ix - pAC->piDepth[iState]; /* Where the earliest match in progress begins */
+    }
+    if (ixStart > ixMatch) {	/* Nothing better can come. Replace the candidate */
+      RULE *pRule = pAC->pRules + iMatch;
+      if (df) {
+	if (ixMatch > ixOut) fwrite(pBuf+ixOut, 1, ixMatch-ixOut, df);
+	fwrite(pRule->pMerged, 1, pRule->nMerged, df);
+      }
+      ix = ixOut = ixMatch + pRule->nOld; /* Resume the search after it */
+      iState = 0;
+      iMatch = -1;
+      lnChanges += 1;
+    }
+  }
+  if (df && (nBuf > ixOut)) fwrite(pBuf+ixOut, 1, nBuf-ixOut, df);
+
+  free(pBuf);
+  return lnChanges;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    SplitLit, SplitAC, ReplaceChunk			      |
+|									      |
+|   Description:    ParallelFilter() callbacks for plain strings	      |
+|									      |
+|   Notes:	    A chunk can end at any position that is not inside an     |
+|		    occurrence of an old string. Then the leftmost longest    |
+|		    matches within the chunk are the same as in the whole     |
+|		    file, and the chunk can be processed independently.       |
+|		    							      |
+|		    SplitLit() searches the occurrences across the end of the |
+|		    buffer, and moves back before them until none remains.    |
+|		    							      |
+|		    SplitAC() runs the automaton on the end of the buffer.    |
+|		    Once it has seen as many bytes as the longest old string, |
+|		    its state is the same as if it had started at the         |
+|		    beginning. The initial state means that no occurrence is  |
+|		    in progress.					      |
+|		    							      |
+|		    ReplaceChunk() runs the same serial routines as for       |
+|		    small files, on memory streams.			      |
+|		    							      |
+|   History:								      |
+|    2026-10-18 JFL Created these routines.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#if defined(_UNIX) /* fmemopen() and open_memstream() are not available in Windows */
+
+size_t SplitLit(const char *pBuf, size_t nBuf, size_t nNew, void *pRef) {
+  PRPARMS *pParms = pRef;
+  size_t nLit = (size_t)pParms->nLit;
+  size_t nSplit, ix;
+  char *pc;
+
+  if (nBuf < nLit) return 0;
+  nSplit = nBuf - nLit + 1;	/* Occurrences ending there are in the buffer */
+  while (nSplit) {
+    ix = (nSplit >= nLit) ? nSplit - nLit + 1 : 0; /* The first one that may span nSplit */
+    pc = FindLiteral((char *)pBuf + ix, nSplit + nLit - 1 - ix, pParms->pLit, nLit);
+    if (!pc) break;
+    nSplit = pc - pBuf;		/* Split before it */
+  }
+  return nSplit;
+}
+
+#define SPLIT_WINDOW 0x10000	/* How far back from the end SplitAC() looks */
+
+size_t SplitAC(const char *pBuf, size_t nBuf, size_t nNew, void *pRef) {
+  PRPARMS *pParms = pRef;
+  ACAUTO *pAC = pParms->pAC;
+  size_t nMin = (size_t)pParms->nMaxOld; /* Bytes to see before the state is known */
+  size_t ix0 = 0;
+  size_t ix, nSplit = 0;
+  int iState = 0;
+
+  if (nBuf > (SPLIT_WINDOW + nMin)) ix0 = nBuf - SPLIT_WINDOW - nMin;
+  for (ix = ix0; ix < nBuf; ) {
+    iState = pAC->piNext[iState * pAC->nClasses + pAC->iClass[(unsigned char)pBuf[ix++]]];
+    if (!iState && (!ix0 || ((ix - ix0) >= nMin))) nSplit = ix;
+  }
+  return nSplit;
+}
+
+long ReplaceChunk(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef) {
+  PRPARMS *pParms = pRef;
+  FILE *sf, *df;
+  char *pOutBuf = NULL;
+  size_t nOutBuf = 0;
+  long lnChanges;
+
+  sf = fmemopen((void *)pBuf, nBuf, "rb");
+  if (!sf) return -1;
+  df = open_memstream(&pOutBuf, &nOutBuf);
+  if (!df) {
+    fclose(sf);
+    return -1;
+  }
+  if (pParms->pAC) {
+    lnChanges = ReplaceAC(sf, df, pParms->pAC);
+  } else {
+    lnChanges = ReplaceLit(sf, df, pParms->pLit, pParms->nLit, pParms->new, pParms->iNewSize);
+  }
+  fclose(sf);
+  if (fclose(df) || PFWrite(pOut, pOutBuf, nOutBuf)) lnChanges = -1;
+  free(pOutBuf);
+  return lnChanges;
+}
+
+#endif /* defined(_UNIX) */
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReplaceParallel	         			      |
+|									      |
+|   Description:    Replace plain strings in a large file in parallel chunks  |
+|									      |
+|   Parameters:     FILE *sf		The input stream		      |
+|		    FILE *df		The output stream, or NULL	      |
+|		    PRPARMS *pParms	What to replace			      |
+|		    long *plnChanges	Where to store the number of changes  |
+|									      |
+|   Returns:	    TRUE if done, FALSE if the caller must do it serially     |
+|									      |
+|   Notes:	    The output is exactly the same as that of ReplaceLit() or |
+|		    ReplaceAC() on the whole file.			      |
+|		    Not used for pipes, nor after the -i input text.	      |
+|		    If df is NULL, only check if anything changes.	      |
+|		    If no thread can be created, ParallelFilter() itself      |
+|		    falls back to a serial StreamFilter() pass.		      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+|    2026-10-18 JFL Removed a dead ENOSYS test after ParallelFilter().	      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int ReplaceParallel(FILE *sf, FILE *df, PRPARMS *pParms, long *plnChanges) {
+#if defined(_UNIX)
+  pf_opts opts = {0};
+  int i;
+
+  if (!(pParms->pAC || pParms->pLit)) return FALSE; /* Regular expressions cannot be split */
+  if (ixBB || !UseParallelFilter(sf, nThreads)) return FALSE;
+  if (pParms->pAC) {
+    pParms->nMaxOld = 0;
+    for (i=0; i<pParms->pAC->nStates; i++) {
+      if (pParms->pAC->piDepth[i] > pParms->nMaxOld) pParms->nMaxOld = pParms->pAC->piDepth[i];
+    }
+  }
+  opts.nThreads = nThreads;
+  opts.pSplitCB = pParms->pAC ? SplitAC : SplitLit;
+  opts.pProcessCB = ReplaceChunk;
+  opts.pRef = pParms;
+  if (ParallelFilter(sf, df, &opts)) {
+    fail("Failed to process the input file. %s", strerror(errno));
+  }
+  *plnChanges = opts.lnChanges;
+  DEBUG_FPRINTF((mf, "// Processed in parallel chunks\n"));
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ReplaceFile	         				      |
+|									      |
+|   Description:    Replace strings in a whole file			      |
+|									      |
+|   Parameters:     FILE *sf		The input stream		      |
+|		    FILE *df		The output stream, or NULL	      |
+|		    void *pRef		PRPARMS *: What to replace	      |
+|									      |
+|   Returns:	    The number of changes, or -1 if failed		      |
+|									      |
+|   Notes:	    FilterDirTree() callback. May run in worker threads.      |
+|		    Files are processed in parallel, so each one is	      |
+|		    processed serially.					      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long ReplaceFile(FILE *sf, FILE *df, void *pRef) {
+  PRPARMS *pParms = pRef;
+  long lnChanges;
+
+  if (pParms->pAC) {
+    lnChanges = ReplaceAC(sf, df, pParms->pAC);
+  } else if (pParms->pLit) {
+    lnChanges = ReplaceLit(sf, df, pParms->pLit, pParms->nLit, pParms->new, pParms->iNewSize);
+  } else {
+    lnChanges = ReplaceRx(sf, df, pParms->pRx, pParms->nRx, pParms->new, pParms->iNewSize);
+  }
+  if (ferror(sf) || (df && ferror(df))) return -1;
+  return lnChanges;
+}
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in callbacks */
+#endif
+
+/* FilterDirTree() callback reporting the files changed, and the errors */
+void ReportReplaced(const char *pszPath, long lnChanges, int iErr, void *pRef) {
+  if (iErr) {
+    fprintf(stderr, "Error: Failed to process %s. %s\n", pszPath, strerror(iErr));
+  } else if (iVerbose) {
+    fprintf(mf, "%s: %ld changes done\n", pszPath, lnChanges);
+  }
+}
+
+#ifdef _MSC_VER
+#pragma warning(default:4100)
+#endif
+
 /*---------------------------------------------------------------------------*\
 *                                                                             *
 |   Function	    IsSameFile						      |
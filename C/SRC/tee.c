@@ -6,6 +6,18 @@
 *									      *
 *   Notes:	    This is a remake of the Unix tee for DOS and Windows.     *
 *									      *
+*		    In Linux, when the input is a pipe, the data is passed to *
+*		    the outputs with tee() and splice(), without copying it   *
+*		    through the user space.				      *
+*									      *
+*		    In Unix, option -t writes every output in its own thread, *
+*		    from its own queue. So a slow output does not slow down   *
+*		    the others, until its queue is full. Then the policy      *
+*		    chosen decides if the input waits, or if the data for     *
+*		    that output is dropped, or put aside in a temporary file. *
+*		    stdout is the fast consumer. So it's never dropped nor    *
+*		    spilled: The input always waits for it.		      *
+*									      *
 *   History:								      *
 *    2012-10-24 JFL Created this program.				      *
 *    2014-12-04 JFL Added my name and email in the help.                      *
@@ -15,6 +27,14 @@
 *    2019-06-12 JFL Added PROGRAM_DESCRIPTION definition. Version 1.1.2.      *
 *    2021-01-06 JFL Fixed the exit code for the help screen. Version 1.1.3.   *
 *    2022-10-20 JFL Use IsSwitch() for the arguments parsing. Version 1.1.4.  *
+*    2026-10-18 JFL Added support for Unix, with zero-copy tee() and splice() *
+*		    in Linux when the input is a pipe. Use a 64 KB buffer.    *
+*		    Report write errors, and continue with the other outputs. *
+*		    Version 1.2.					      *
+*    2026-10-18 JFL Added options -t and -q for writing every output in its   *
+*		    own thread, through a queue. Version 1.3.		      *
+*    2026-10-18 JFL Always wait for stdout. Only drop data for files whose    *
+*		    writer made no progress for 100 ms. Version 1.3.1.	      *
 *                                                                             *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -22,17 +42,20 @@
 
 #define PROGRAM_DESCRIPTION "Duplicate the input to several outputs"
 #define PROGRAM_NAME    "tee"
-#define PROGRAM_VERSION "1.1.4"
-#define PROGRAM_DATE    "2022-10-20"
+#define PROGRAM_VERSION "1.3.1"
+#define PROGRAM_DATE    "2026-10-18"
 
 #define _CRT_SECURE_NO_WARNINGS 1 /* Avoid Visual C++ 2005 security warnings */
 
 #define _UTF8_SOURCE	/* Enable MsvcLibX support for file names with Unicode characters */
 
+#define _GNU_SOURCE	/* Enable Linux' splice() and tee() */
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/types.h>
 /* SysToolsLib include files */
@@ -56,6 +79,8 @@
 
 #include <io.h>
 
+#define BUFSIZE 1024	/* Keep it well below the 64 KB segment size */
+
 #endif
 
 /************************* Unix-specific definitions *************************/
@@ -64,9 +89,18 @@
 
 #define _UNIX
 
-#error "Unsupported OS. Please add support if needed."
-
 #include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+#define HAS_PARALLEL 1	/* Use pthreads for writing every output in parallel */
+
+#include <pthread.h>
+#include <time.h>
+
+#if defined(__linux__)		/* splice() and tee() are Linux-specific */
+#define HAS_SPLICE 1
+#endif
 
 #endif /* defined(__unix__) */
 
@@ -74,12 +108,45 @@
 
 /* Local definitions */
 
-#define BUFSIZE 1024
+#ifndef BUFSIZE
+#define BUFSIZE 0x10000	/* The default pipe size in Linux */
+#endif
+
+#ifndef EPIPE		/* Missing in old DOS C libraries */
+#define EPIPE 32
+#endif
+#ifndef EIO
+#define EIO 5
+#endif
+
+#if HAS_PARALLEL
+#define QUEUE_SIZE 0x100000L	/* Default queue size for every output */
+#define STALL_TIMEOUT 100	/* ms. A writer with no progress for that long is stalled */
+typedef enum {Q_NONE, Q_BLOCK, Q_DROP, Q_SPILL} queuePolicy; /* What to do when a queue is full */
+#endif
 
 typedef struct _outStream {
   char *name;
   FILE *f;
+  int iErr;			/* The first write error, or 0 if none */
+  int noSplice;			/* TRUE if splice() can't write to it. Ex: In append mode */
   struct _outStream *next;
+#if HAS_PARALLEL
+  pthread_t hThread;		/* The thread writing the queue */
+  pthread_mutex_t mutex;	/* Protects iErr, and everything below */
+  pthread_cond_t cond;		/* Signaled when data is queued or written */
+  char *pQueue;			/* Ring buffer with the data to write */
+  size_t lQueue;		/* Its size */
+  size_t nIn;			/* Number of bytes queued. May wrap around */
+  size_t nOut;			/* Number of bytes written. May wrap around */
+  FILE *fSpill;			/* Temporary file for the data that did not fit */
+  off_t oSpillIn;		/* End of the data in that file */
+  off_t oSpillOut;		/* End of the data already written from it */
+  unsigned long long nDropped;	/* Number of bytes dropped */
+  int iStalled;			/* TRUE if the writer made no progress since nStallOut */
+  size_t nStallOut;		/* The nOut value when it was found stalled */
+  int iEOF;			/* TRUE when no more data will be queued */
+#endif
 } outStream;
 
 /* Forward references */
@@ -87,6 +154,15 @@ typedef struct _outStream {
 void usage(void);			/* Display a brief help screen */
 outStream *NewOutStream(char *pszName, char *pszMode, outStream *last);
 size_t GetDefaultBufSize();
+int WriteOut(outStream *pStream, const char *pBuf, size_t nBuf);
+int WriteError(outStream *pStream);
+int CopyInput(outStream *pFirst, char *pBuf, size_t szBuf);
+#if HAS_SPLICE
+int SpliceInput(outStream *pFirst, char *pBuf, size_t szBuf);
+#endif
+#if HAS_PARALLEL
+int ThreadInput(outStream *pFirst, char *pBuf, size_t szBuf, queuePolicy iPolicy, size_t lQueue);
+#endif
 
 /******************************************************************************
 *                                                                             *
@@ -105,6 +181,8 @@ size_t GetDefaultBufSize();
 *                                                                             *
 *   History                                                                   *
 *    2012-10-24 JFL Created this program.				      *
+*    2026-10-18 JFL Return 1 if the input or an output failed.		      *
+*    2026-10-18 JFL Added options -t and -q.				      *
 *                                                                             *
 ******************************************************************************/
 
@@ -117,7 +195,14 @@ int main(int argc, char *argv[]) {
   size_t szBuf = BUFSIZE;
   char *pBuf;
   char *pBufSize;
-  ssize_t nRead;
+  int iRet;
+#if HAS_SPLICE
+  struct stat st;
+#endif
+#if HAS_PARALLEL
+  queuePolicy iPolicy = Q_NONE;
+  size_t lQueue = QUEUE_SIZE;
+#endif
 
   pFirst = pLast = NewOutStream(NULL, NULL, NULL); /* Always output to stdout */
 
@@ -148,6 +233,26 @@ int main(int argc, char *argv[]) {
 	if ((i+1)<argc) szBuf = atoi(argv[++i]);
 	continue;
       }
+#if HAS_PARALLEL
+      if (streq(option, "q") && ((i+1)<argc)) { /* -q SIZE: Queue size for -t */
+	lQueue = (size_t)strtoul(argv[++i], NULL, 0);
+	continue;
+      }
+      if (streq(option, "t") && ((i+1)<argc)) { /* -t POLICY: Write every output in its own thread */
+	char *pszPolicy = argv[++i];
+	if (streq(pszPolicy, "block")) {
+	  iPolicy = Q_BLOCK;
+	} else if (streq(pszPolicy, "drop")) {
+	  iPolicy = Q_DROP;
+	} else if (streq(pszPolicy, "spill")) {
+	  iPolicy = Q_SPILL;
+	} else {
+	  fprintf(stderr, "Invalid queue policy: %s\n", pszPolicy);
+	  exit(1);
+	}
+	continue;
+      }
+#endif
       if (streq(option, "V") || streq(option, "-version")) { /* -V: Display the version */
 	puts(DETAILED_VERSION);
 	exit(0);
@@ -161,6 +266,7 @@ int main(int argc, char *argv[]) {
     continue;
   }
 
+  if (!szBuf) szBuf = BUFSIZE;
   pBuf = malloc(szBuf);
   if (!pBuf) {
     fprintf(stderr, "Not enough memory\n");
@@ -168,8 +274,15 @@ int main(int argc, char *argv[]) {
   }
 
   /* Make sure no translation is done on stdin or stdout */
+#if defined(_MSDOS) || defined(_WIN32)
   _setmode(_fileno(stdin),  _O_BINARY);
   _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+#ifdef _UNIX
+  /* Report a closed pipe as a write error, and go on with the other outputs */
+  signal(SIGPIPE, SIG_IGN);
+#endif
 
   /* Make sure no buffering is used on any output file */
   for (pStream = pFirst; pStream; pStream = pStream->next) {
@@ -180,19 +293,23 @@ int main(int argc, char *argv[]) {
   }
 
   /* Copy all incoming data */
-  while ((nRead = read(0, pBuf, (int)szBuf)) > 0) { /* Use read to avoid buffering the input */ /* Cast (int) as MS version takes an in */
-    /*
-    printf("Read %d bytes: ", nRead);
-    fwrite(pBuf, 1, nRead, stdout);
-    printf("\n");
-    */
-    for (pStream = pFirst; pStream; pStream = pStream->next) {
-      /* printf("Writing to %s\n", pStream->name); */
-      fwrite(pBuf, 1, nRead, pStream->f);
-    }
-  }
+#if HAS_PARALLEL
+  if (iPolicy != Q_NONE) {
+    iRet = ThreadInput(pFirst, pBuf, szBuf, iPolicy, lQueue);
+  } else
+#endif
+#if HAS_SPLICE
+  if (!fstat(0, &st) && S_ISFIFO(st.st_mode)) {
+    iRet = SpliceInput(pFirst, pBuf, szBuf);
+  } else
+#endif
+  iRet = CopyInput(pFirst, pBuf, szBuf);
+  if (iRet) fprintf(stderr, "Error reading the input. %s\n", strerror(errno));
 
-  return 0;
+  for (pStream = pFirst; pStream; pStream = pStream->next) {
+    if (pStream->iErr && (pStream->iErr != EPIPE)) iRet = -1;
+  }
+  return iRet ? 1 : 0;
 }
 
 void usage(void) {
@@ -205,6 +322,18 @@ Options:\n\
   -?	    Display this help screen.\n\
   -a	    Append to the next file. Default: Overwrite it.\n\
   -b	    Set the buffer size. Default: %lu\n\
+"
+#if HAS_PARALLEL
+"\
+  -q SIZE   Set the queue size for every output with -t. Default: 1 MB\n\
+  -t POLICY Write every output in its own thread, through a queue. POLICY =\n\
+            What to do when an output is too slow, and its queue is full:\n\
+	    block = Wait for it; drop = Skip the data for that output, if\n\
+	    it made no progress for 100 ms; spill = Queue the data in a\n\
+	    temporary file. stdout always uses block.\n\
+"
+#endif
+"\
   -V        Display the program version\n\
 \n\
 Note: The buffer size can also be set by environment variable TEE_BUFSIZE.\n\
@@ -221,6 +350,8 @@ outStream *NewOutStream(char *pszName, char *pszMode, outStream *last) {
     exit(1);
   }
   pStream->name = pszName;
+  pStream->iErr = 0;
+  pStream->noSplice = FALSE;
   pStream->next = NULL;
   if (pszName) {
     pStream->f = fopen(pszName, pszMode);
@@ -249,4 +380,466 @@ size_t GetDefaultBufSize() {
   return szBuf;
 }
 
+/******************************************************************************
+*                                                                             *
+*   Function	    WriteOut						      *
+*                                                                             *
+*   Description     Write data to one output, and report failures	      *
+*                                                                             *
+*   Arguments                                                                 *
+*                                                                             *
+*	  outStream *pStream	The output				      *
+*	  const char *pBuf	The data				      *
+*	  size_t nBuf		Its size				      *
+*                                                                             *
+*   Return value    0=Success; -1=Failure, and pStream->iErr set	      *
+*                                                                             *
+*   Notes	    A failed output is skipped afterwards, so that a full     *
+*		    disk or a closed pipe does not stop the other outputs.    *
+*		    Closed pipes are not reported, as this is the normal way  *
+*		    for commands like head to stop reading.		      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this routine.				      *
+*                                                                             *
+******************************************************************************/
+
+int WriteOut(outStream *pStream, const char *pBuf, size_t nBuf) {
+  if (fwrite(pBuf, 1, nBuf, pStream->f) == nBuf) return 0;
+  return WriteError(pStream);
+}
+
+int WriteError(outStream *pStream) {
+  pStream->iErr = errno ? errno : EIO;
+  if (pStream->iErr != EPIPE) {
+    fprintf(stderr, "Error writing to %s. %s\n", pStream->name, strerror(pStream->iErr));
+  }
+  return -1;
+}
+
+/******************************************************************************
+*                                                                             *
+*   Function	    CopyInput						      *
+*                                                                             *
+*   Description     Copy the input to all outputs through a buffer	      *
+*                                                                             *
+*   Arguments                                                                 *
+*                                                                             *
+*	  outStream *pFirst	The list of outputs			      *
+*	  char *pBuf		The buffer				      *
+*	  size_t szBuf		Its size				      *
+*                                                                             *
+*   Return value    0=Success; -1=Input error                                 *
+*                                                                             *
+*   Notes	    Use read() to avoid buffering the input. This way, the    *
+*		    data is output as soon as it's available.		      *
+*		    Stops early if all outputs failed.			      *
+*                                                                             *
+*   History                                                                   *
+*    2012-10-24 JFL Created this routine in main().			      *
+*    2026-10-18 JFL Moved to this routine. Skip the failed outputs.	      *
+*                                                                             *
+******************************************************************************/
+
+int CopyInput(outStream *pFirst, char *pBuf, size_t szBuf) {
+  ssize_t nRead;
+  outStream *pStream;
+
+  while ((nRead = read(0, pBuf, (int)szBuf)) > 0) { /* Cast (int) as MS version takes an int */
+    int nLive = 0;
+    for (pStream = pFirst; pStream; pStream = pStream->next) {
+      if (!pStream->iErr && !WriteOut(pStream, pBuf, (size_t)nRead)) nLive += 1;
+    }
+    if (!nLive) return 0;	/* All outputs failed. Don't wait for more input */
+  }
+  return (nRead < 0) ? -1 : 0;
+}
+
+#if HAS_SPLICE
+
+/******************************************************************************
+*                                                                             *
+*   Function	    SpliceInput						      *
+*                                                                             *
+*   Description     Copy a pipe input to all outputs, without copying the data*
+*                                                                             *
+*   Arguments                                                                 *
+*                                                                             *
+*	  outStream *pFirst	The list of outputs			      *
+*	  char *pBuf		A buffer for the outputs that need one	      *
+*	  size_t szBuf		Its size				      *
+*                                                                             *
+*   Return value    0=Success; -1=Input error                                 *
+*                                                                             *
+*   Notes	    For each block of input, tee() duplicates the pipe pages  *
+*		    into an internal pipe, without consuming the input, and   *
+*		    splice() moves them to one output. This is repeated for   *
+*		    every output but the last, which gets the input pages     *
+*		    themselves.						      *
+*		    The first tee() sets the block size. The next ones start  *
+*		    at the same place in the same input, so they return that  *
+*		    same size.						      *
+*		    Outputs that splice() refuses, like files opened in       *
+*		    append mode, are written from the buffer.		      *
+*		    If only one output remains, splice() moves the input to   *
+*		    it directly.					      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this routine.				      *
+*                                                                             *
+******************************************************************************/
+
+/* Move n bytes from pipe fdIn to an output. Update *pn. 0=Success; -1=Output error */
+int SpliceOut(int fdIn, size_t *pn, outStream *pStream, char *pBuf, size_t szBuf) {
+  while (*pn) {
+    ssize_t n;
+    if (!pStream->noSplice) {
+      n = splice(fdIn, NULL, fileno(pStream->f), NULL, *pn, SPLICE_F_MOVE);
+      if ((n < 0) && (errno == EINVAL)) { /* This output does not support splice() */
+	pStream->noSplice = TRUE;
+	continue;
+      }
+      if ((n < 0) && (errno == EINTR)) continue;
+      if (n <= 0) return WriteError(pStream);
+      *pn -= (size_t)n;
+    } else {
+      n = read(fdIn, pBuf, (*pn < szBuf) ? *pn : szBuf);
+      if ((n < 0) && (errno == EINTR)) continue;
+      if (n <= 0) return -1;
+      *pn -= (size_t)n;
+      if (WriteOut(pStream, pBuf, (size_t)n)) return -1;
+    }
+  }
+  return 0;
+}
+
+/* Drop n bytes from pipe fdIn */
+void SpliceDrop(int fdIn, size_t n, char *pBuf, size_t szBuf) {
+  while (n) {
+    ssize_t nRead = read(fdIn, pBuf, (n < szBuf) ? n : szBuf);
+    if ((nRead < 0) && (errno == EINTR)) continue;
+    if (nRead <= 0) break;
+    n -= (size_t)nRead;
+  }
+}
+
+int SpliceInput(outStream *pFirst, char *pBuf, size_t szBuf) {
+  int hPipe[2];			/* The internal pipe */
+  int iRet = 0;
+
+  if (pipe(hPipe)) return CopyInput(pFirst, pBuf, szBuf);
+  fcntl(hPipe[1], F_SETPIPE_SZ, (int)szBuf); /* Try making it as large as the buffer. OK if it fails */
+
+  while (!iRet) {
+    outStream *pStream;
+    outStream *pLast = NULL;	/* The last output still working */
+    int nLive = 0;
+    ssize_t n, nTee;
+    size_t nLeft;
+
+    for (pStream = pFirst; pStream; pStream = pStream->next) {
+      if (!pStream->iErr) {
+	pLast = pStream;
+	nLive += 1;
+      }
+    }
+    if (!nLive) break;		/* All outputs failed. Don't wait for more input */
+
+    if ((nLive == 1) && !pLast->noSplice) { /* Move the input pages to the last output */
+      n = splice(0, NULL, fileno(pLast->f), NULL, szBuf, SPLICE_F_MOVE);
+      if ((n < 0) && (errno == EINVAL)) {
+	pLast->noSplice = TRUE;
+	continue;
+      }
+      if ((n < 0) && (errno == EINTR)) continue;
+      if (n == 0) break;	/* End of input */
+      if (n < 0) WriteError(pLast);
+      continue;
+    }
+    if (nLive == 1) {		/* Nothing left to duplicate */
+      iRet = CopyInput(pLast, pBuf, szBuf);
+      break;
+    }
+
+    /* Duplicate the next block of input into the internal pipe */
+    do {
+      n = tee(0, hPipe[1], szBuf, 0);
+    } while ((n < 0) && (errno == EINTR));
+    if (n == 0) break;		/* End of input */
+    if (n < 0) {
+      if (errno == EINVAL) iRet = CopyInput(pFirst, pBuf, szBuf); /* Nothing consumed yet */
+      else iRet = -1;
+      break;
+    }
+
+    nTee = n;			/* The internal pipe contains a copy of the block */
+    for (pStream = pFirst; pStream != pLast; pStream = pStream->next) {
+      if (pStream->iErr) continue;
+      if (!nTee) {
+	do {
+	  nTee = tee(0, hPipe[1], (size_t)n, 0);
+	} while ((nTee < 0) && (errno == EINTR));
+	if (nTee != n) {	/* Should not happen, as the input has not changed */
+	  if (nTee > 0) SpliceDrop(hPipe[0], (size_t)nTee, pBuf, szBuf);
+	  errno = EIO;
+	  iRet = -1;
+	  break;
+	}
+      }
+      nLeft = (size_t)nTee;
+      SpliceOut(hPipe[0], &nLeft, pStream, pBuf, szBuf);
+      SpliceDrop(hPipe[0], nLeft, pBuf, szBuf); /* If that output failed */
+      nTee = 0;
+    }
+    if (iRet) break;
+
+    /* Move the input block itself to the last output */
+    nLeft = (size_t)n;
+    SpliceOut(0, &nLeft, pLast, pBuf, szBuf);
+    SpliceDrop(0, nLeft, pBuf, szBuf); /* If that output failed */
+  }
+
+  close(hPipe[0]);
+  close(hPipe[1]);
+  return iRet;
+}
+
+#endif /* HAS_SPLICE */
+
+#if HAS_PARALLEL
+
+/******************************************************************************
+*                                                                             *
+*   Function	    ThreadInput						      *
+*                                                                             *
+*   Description     Copy the input to all outputs through per-output threads  *
+*                                                                             *
+*   Arguments                                                                 *
+*                                                                             *
+*	  outStream *pFirst	The list of outputs			      *
+*	  char *pBuf		The input buffer			      *
+*	  size_t szBuf		Its size				      *
+*	  queuePolicy iPolicy	What to do when a queue is full		      *
+*	  size_t lQueue		The queue size for every output		      *
+*                                                                             *
+*   Return value    0=Success; -1=Input error                                 *
+*                                                                             *
+*   Notes	    Every output gets a ring buffer, and a thread writing it. *
+*		    The main thread only copies the input into the queues.    *
+*		    When a queue is full, the block of input is:	      *
+*		    Q_BLOCK: Queued when there's enough room. So the input    *
+*		             goes at the pace of the slowest output.	      *
+*		    Q_DROP:  Queued when there's enough room, as long as the  *
+*		             writer makes progress. Dropped for that output   *
+*		             if it made none for STALL_TIMEOUT ms, and then   *
+*		             without waiting, until it makes progress again.  *
+*		             The number of bytes dropped is reported in the   *
+*		             end.					      *
+*		    Q_SPILL: Appended to a temporary file, and so are all the *
+*		             next blocks, until the thread has written all of *
+*		             it. This keeps the data in order.		      *
+*		    The spill file is written and read with pwrite() and      *
+*		    pread(), without holding the lock. The main thread only   *
+*		    appends beyond oSpillIn, and the writer only reads before *
+*		    it. Only the main thread rewinds it, once it's empty.     *
+*		    stdout always uses Q_BLOCK. It's the fast consumer that   *
+*		    the other policies protect. Dropping or spilling its data *
+*		    would only corrupt it, as the input can't go faster	      *
+*		    than the main thread copying it into the queues.	      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this routine.				      *
+*                                                                             *
+******************************************************************************/
+
+/* Write the queue of one output. Runs in its own thread */
+void *WriterThread(void *pArg) {
+  outStream *pStream = pArg;
+  char *pSpillBuf = NULL;	/* Buffer for reading the spill file */
+  size_t lSpillBuf = (pStream->lQueue < BUFSIZE) ? pStream->lQueue : BUFSIZE;
+
+  pthread_mutex_lock(&pStream->mutex);
+  while (!pStream->iErr) {
+    size_t nQueued = pStream->nIn - pStream->nOut;
+    const char *pData = NULL;
+    size_t nData;
+    off_t oSpill = -1;
+    int iErr = 0;
+
+    if (nQueued) {		/* The queue contains the oldest data */
+      size_t iOut = pStream->nOut % pStream->lQueue;
+      pData = pStream->pQueue + iOut;
+      nData = pStream->lQueue - iOut;
+      if (nData > nQueued) nData = nQueued;
+    } else if (pStream->oSpillOut < pStream->oSpillIn) { /* Then the spill file */
+      oSpill = pStream->oSpillOut;
+      nData = lSpillBuf;
+      if ((off_t)nData > (pStream->oSpillIn - oSpill)) nData = (size_t)(pStream->oSpillIn - oSpill);
+    } else if (pStream->iEOF) {
+      break;			/* All done */
+    } else {
+      pthread_cond_wait(&pStream->cond, &pStream->mutex);
+      continue;
+    }
+    pthread_mutex_unlock(&pStream->mutex);
+
+    if (oSpill >= 0) {
+      if (!pSpillBuf) pSpillBuf = malloc(lSpillBuf);
+      pData = pSpillBuf;
+      if (!pSpillBuf) {
+	iErr = ENOMEM;
+      } else if (pread(fileno(pStream->fSpill), pSpillBuf, nData, oSpill) != (ssize_t)nData) {
+	iErr = errno ? errno : EIO;
+      }
+    }
+    if (!iErr && (fwrite(pData, 1, nData, pStream->f) != nData)) iErr = errno ? errno : EIO;
+
+    pthread_mutex_lock(&pStream->mutex);
+    if (iErr) {
+      errno = iErr;
+      WriteError(pStream);
+    } else if (oSpill >= 0) {
+      pStream->oSpillOut += nData;
+    } else {
+      pStream->nOut += nData;
+    }
+    pthread_cond_broadcast(&pStream->cond);
+  }
+  pthread_cond_broadcast(&pStream->cond); /* In case the main thread waits for room */
+  pthread_mutex_unlock(&pStream->mutex);
+  free(pSpillBuf);
+  return NULL;
+}
+
+/* Queue data for one output. 0=Success; -1=That output failed */
+int QueueOut(outStream *pStream, const char *pBuf, size_t nBuf, queuePolicy iPolicy) {
+  size_t nFree;
+  off_t oSpill;
+  int iErr = 0;
+
+  if (pStream->f == stdout) iPolicy = Q_BLOCK; /* Never drop or spill the fast consumer data */
+  pthread_mutex_lock(&pStream->mutex);
+  if (iPolicy == Q_BLOCK) {
+    while (!pStream->iErr && ((pStream->lQueue - (pStream->nIn - pStream->nOut)) < nBuf)) {
+      pthread_cond_wait(&pStream->cond, &pStream->mutex);
+    }
+  } else if (iPolicy == Q_DROP) { /* Wait for room as long as the writer makes progress */
+    while (!pStream->iErr && ((pStream->lQueue - (pStream->nIn - pStream->nOut)) < nBuf)) {
+      size_t nOut = pStream->nOut;
+      struct timespec ts;
+      int iTimeout = FALSE;
+      if (pStream->iStalled && (pStream->nStallOut == nOut)) break; /* Still stalled. Don't wait again */
+      pStream->iStalled = FALSE;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      ts.tv_nsec += STALL_TIMEOUT * 1000000L;
+      if (ts.tv_nsec >= 1000000000L) {
+	ts.tv_sec += ts.tv_nsec / 1000000000L;
+	ts.tv_nsec %= 1000000000L;
+      }
+      while (!pStream->iErr && (pStream->nOut == nOut) && !iTimeout) {
+	iTimeout = (pthread_cond_timedwait(&pStream->cond, &pStream->mutex, &ts) == ETIMEDOUT);
+      }
+      if (pStream->nOut == nOut) { /* It's stalled. Drop the data below */
+	pStream->iStalled = TRUE;
+	pStream->nStallOut = nOut;
+	break;
+      }
+    }
+  }
+  if (pStream->iErr) {
+    pthread_mutex_unlock(&pStream->mutex);
+    return -1;
+  }
+  if (pStream->oSpillOut == pStream->oSpillIn) { /* Rewind the empty spill file */
+    pStream->oSpillIn = pStream->oSpillOut = 0;
+  }
+  nFree = pStream->lQueue - (pStream->nIn - pStream->nOut);
+  if ((nBuf <= nFree) && !pStream->oSpillIn) { /* Append it to the queue */
+    size_t iIn = pStream->nIn % pStream->lQueue;
+    size_t n = pStream->lQueue - iIn;
+    if (n > nBuf) n = nBuf;
+    memcpy(pStream->pQueue + iIn, pBuf, n);
+    memcpy(pStream->pQueue, pBuf + n, nBuf - n);
+    pStream->nIn += nBuf;
+  } else if (iPolicy == Q_DROP) {
+    pStream->nDropped += nBuf;
+  } else {			/* Q_SPILL. Append it to the spill file */
+    if (!pStream->fSpill) pStream->fSpill = tmpfile();
+    oSpill = pStream->oSpillIn;
+    pthread_mutex_unlock(&pStream->mutex);
+    if (   !pStream->fSpill
+        || (pwrite(fileno(pStream->fSpill), pBuf, nBuf, oSpill) != (ssize_t)nBuf)) {
+      iErr = errno ? errno : EIO;
+    }
+    pthread_mutex_lock(&pStream->mutex);
+    if (iErr) {
+      fprintf(stderr, "Error spilling the data for %s. %s\n", pStream->name, strerror(iErr));
+      pStream->iErr = iErr;
+    } else {
+      pStream->oSpillIn = oSpill + (off_t)nBuf;
+    }
+  }
+  pthread_cond_broadcast(&pStream->cond);
+  pthread_mutex_unlock(&pStream->mutex);
+  return iErr ? -1 : 0;
+}
+
+int ThreadInput(outStream *pFirst, char *pBuf, size_t szBuf, queuePolicy iPolicy, size_t lQueue) {
+  outStream *pStream;
+  ssize_t nRead;
+  int iRet = 0;
+
+  if (lQueue < szBuf) lQueue = szBuf; /* Leave room for at least one block */
+
+  /* Start a writer thread for every output */
+  for (pStream = pFirst; pStream; pStream = pStream->next) {
+    pStream->pQueue = malloc(lQueue);
+    if (!pStream->pQueue) {
+      fprintf(stderr, "Not enough memory\n");
+      exit(1);
+    }
+    pStream->lQueue = lQueue;
+    pStream->nIn = pStream->nOut = 0;
+    pStream->fSpill = NULL;
+    pStream->oSpillIn = pStream->oSpillOut = 0;
+    pStream->nDropped = 0;
+    pStream->iStalled = FALSE;
+    pStream->iEOF = FALSE;
+    pthread_mutex_init(&pStream->mutex, NULL);
+    pthread_cond_init(&pStream->cond, NULL);
+    if (pthread_create(&pStream->hThread, NULL, WriterThread, pStream)) {
+      fprintf(stderr, "Cannot create a thread for %s\n", pStream->name);
+      exit(1);
+    }
+  }
+
+  while ((nRead = read(0, pBuf, szBuf)) > 0) {
+    int nLive = 0;
+    for (pStream = pFirst; pStream; pStream = pStream->next) {
+      if (!QueueOut(pStream, pBuf, (size_t)nRead, iPolicy)) nLive += 1;
+    }
+    if (!nLive) break;		/* All outputs failed. Don't wait for more input */
+  }
+  if (nRead < 0) iRet = -1;
+
+  /* Let the threads write what remains in their queues */
+  for (pStream = pFirst; pStream; pStream = pStream->next) {
+    pthread_mutex_lock(&pStream->mutex);
+    pStream->iEOF = TRUE;
+    pthread_cond_broadcast(&pStream->cond);
+    pthread_mutex_unlock(&pStream->mutex);
+  }
+  for (pStream = pFirst; pStream; pStream = pStream->next) {
+    pthread_join(pStream->hThread, NULL);
+    if (pStream->nDropped) {
+      fprintf(stderr, "Dropped %llu bytes for %s\n", pStream->nDropped, pStream->name);
+    }
+    if (pStream->fSpill) fclose(pStream->fSpill);
+    free(pStream->pQueue);
+    pthread_cond_destroy(&pStream->cond);
+    pthread_mutex_destroy(&pStream->mutex);
+  }
+  return iRet;
+}
 
+#endif /* HAS_PARALLEL */
@@ -0,0 +1,56 @@
+#!/bin/sh
+###############################################################################
+#                                                                             #
+#   Filename        bench-mktree.sh                                           #
+#                                                                             #
+#   Description     Create a reproducible tree of small files for benchmarks  #
+#                                                                             #
+#   Notes           Usage: bench-mktree.sh DIR [NFILES [NDIRS [MAXSIZE]]]     #
+#                   DIR             The directory to create. Must not exist.  #
+#                   NFILES          Total number of files. Default: 10000     #
+#                   NDIRS           Number of subdirectories. Default: 40     #
+#                   MAXSIZE         Maximum file size, in bytes.              #
+#                                   Default: 65536                            #
+#                                                                             #
+#                   The file sizes are random, between 0 and MAXSIZE, but     #
+#                   use a fixed seed. So the same arguments always create     #
+#                   the same tree, with the same contents.                    #
+#                                                                             #
+#   History                                                                   #
+#    2026-10-18 JFL Created this script.                                      #
+#                                                                             #
+#         © Copyright 2026 Hewlett Packard Enterprise Development LP          #
+# Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 #
+###############################################################################
+
+if [ -z "$1" ] ; then
+  echo "Usage: $0 DIR [NFILES [NDIRS [MAXSIZE]]]" >&2
+  exit 1
+fi
+if [ -e "$1" ] ; then
+  echo "Error: $1 already exists" >&2
+  exit 1
+fi
+DIR=$1
+NFILES=${2:-10000}
+NDIRS=${3:-40}
+MAXSIZE=${4:-65536}
+
+mkdir -p "$DIR" || exit 1
+
+# Use awk for speed, as it can write all files itself
+awk -v dir="$DIR" -v nfiles="$NFILES" -v ndirs="$NDIRS" -v maxsize="$MAXSIZE" 'BEGIN {
+  srand(1);
+  for (d = 0; d < ndirs; d++) {
+    system("mkdir -p \"" dir "/d" d "\"");
+    nf = int(nfiles / ndirs) + (d < (nfiles % ndirs));
+    for (f = 0; f < nf; f++) {
+      name = dir "/d" d "/f" f;
+      n = int(rand() * (maxsize + 1));
+      line = sprintf("%063d\n", d * 100000 + f);
+      for (i = 0; (i + 64) <= n; i += 64) printf("%s", line) > name;
+      printf("%s", substr(line, 1, n - i)) > name;
+      close(name);
+    }
+  }
+}'
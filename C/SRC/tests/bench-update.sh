@@ -0,0 +1,107 @@
+#!/bin/sh
+###############################################################################
+#                                                                             #
+#   Filename        bench-update.sh                                           #
+#                                                                             #
+#   Description     Compare the speed of two update commands on small files   #
+#                                                                             #
+#   Notes           Usage: bench-update.sh CMD_A [CMD_B [DIR [N]]]            #
+#                   CMD_A, CMD_B    update programs, with optional options.   #
+#                                   Ex: "bin/update" "old/update -a"          #
+#                                   Default CMD_B: The same as CMD_A.         #
+#                   DIR             Where to create the test trees.           #
+#                                   Default: $TMPDIR or /tmp.                 #
+#                   N               Number of runs of each command. Default: 5#
+#                                                                             #
+#                   Creates a tree of 10000 files of 0-64 KB in 40 dirs with  #
+#                   bench-mktree.sh. Then copies it N times with each command,#
+#                   alternating them, into a new empty target each time.      #
+#                   Each copy is followed by an untimed sync, so that the     #
+#                   dirty data left by one run does not slow down the next    #
+#                   one. So this measures the time spent in update itself,    #
+#                   in system calls and in page cache copies. Displays the    #
+#                   best and median times, and checks that both commands      #
+#                   create identical copies.                                  #
+#                                                                             #
+#                   The io_uring batched copy mode, update -a, was removed    #
+#                   after measuring it with this script. To measure it again, #
+#                   build update from commit d9f7e3d as old/update, then run: #
+#                   bench-update.sh "bin/update" "old/update -a" /tmp 9       #
+#                                                                             #
+#   History                                                                   #
+#    2026-10-18 JFL Created this script.                                      #
+#                                                                             #
+#         © Copyright 2026 Hewlett Packard Enterprise Development LP          #
+# Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 #
+###############################################################################
+
+if [ -z "$1" ] ; then
+  echo "Usage: $0 CMD_A [CMD_B [DIR [N]]]" >&2
+  exit 1
+fi
+
+# Make the program pathname absolute, keeping the options that follow it
+Absolute() { # $1=Command line
+  set -- $1
+  PROG=$1
+  shift
+  case "$PROG" in */*) PROG=$(cd "$(dirname "$PROG")" && pwd)/$(basename "$PROG") ;; esac
+  echo "$PROG $*"
+}
+
+CMD_A=$(Absolute "$1")
+CMD_B=$(Absolute "${2:-$1}")
+TMP=${3:-${TMPDIR:-/tmp}}/bench-update.$$
+RUNS=${4:-5}
+MKTREE="$(cd "$(dirname "$0")" && pwd)/bench-mktree.sh"
+
+trap 'rm -rf "$TMP"' 0
+mkdir -p "$TMP" || exit 1
+cd "$TMP" || exit 1
+
+echo "Creating 10000 files in $TMP/src ..."
+sh "$MKTREE" src 10000 40 65536 || exit 1
+sync
+
+# Time a command in milliseconds. $1=Output variable; $2...=Command
+Time() { # $1=Variable name; Other args=Command
+  VAR=$1
+  shift
+  T0=$(date +%s%N)
+  "$@" >/dev/null 2>&1
+  T1=$(date +%s%N)
+  eval "$VAR=\$(( (T1 - T0) / 1000000 ))"
+  sync	# Write the data to disk now, so that it does not slow down the next run
+}
+
+# Display the best and the median of a list of times
+Stats() { # $1=Command; Other args=Times in ms
+  CMD=$1
+  shift
+  printf "%s\n" "$@" | sort -n | awk -v cmd="$CMD" '
+    { t[NR] = $1 }
+    END { printf("best %5d ms   median %5d ms   (%d runs)   %s\n", t[1], t[int((NR+1)/2)], NR, cmd) }'
+}
+
+TIMES_A=""
+TIMES_B=""
+i=0
+while [ $i -lt $RUNS ] ; do
+  rm -rf dst1 dst2
+  sync
+  Time T $CMD_A -q -r "src/*" dst1/
+  TIMES_A="$TIMES_A $T"
+  Time T $CMD_B -q -r "src/*" dst2/
+  TIMES_B="$TIMES_B $T"
+  i=$((i + 1))
+done
+
+Stats "$CMD_A" $TIMES_A
+Stats "$CMD_B" $TIMES_B
+
+if diff -r src dst1 >/dev/null && diff -r src dst2 >/dev/null ; then
+  echo "Copies identical"
+else
+  echo "FAILED: The copies differ"
+  exit 1
+fi
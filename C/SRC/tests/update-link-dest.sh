@@ -0,0 +1,69 @@
+#!/bin/sh
+###############################################################################
+#                                                                             #
+#   Filename        update-link-dest.sh                                       #
+#                                                                             #
+#   Description     Regression test for update -L|--link-dest                 #
+#                                                                             #
+#   Notes           Usage: update-link-dest.sh [UPDATE_PROGRAM]               #
+#                   Default program: update in the PATH.                      #
+#                   Exit code: 0=Success, 1=Failure                           #
+#                                                                             #
+#                   A first run hard-links the target to the reference file.  #
+#                   A second run with a changed source must replace the       #
+#                   target, without changing the reference file, nor leaving  #
+#                   a temporary file behind.                                  #
+#                   Without -L, a target hard-linked to another file must     #
+#                   still be updated in place, keeping the link.              #
+#                                                                             #
+#                   Run by `make test` in C/SRC.                              #
+#                                                                             #
+#   History                                                                   #
+#    2026-10-18 JFL Created this script.                                      #
+#    2026-10-18 JFL Added the hard links without -L test.                     #
+#                                                                             #
+#         © Copyright 2026 Hewlett Packard Enterprise Development LP          #
+# Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 #
+###############################################################################
+
+UPDATE=${1:-update}
+case "$UPDATE" in */*) UPDATE=$(cd "$(dirname "$UPDATE")" && pwd)/$(basename "$UPDATE") ;; esac # Make it absolute
+TMP=${TMPDIR:-/tmp}/update-link-dest.$$
+ERR=0
+
+Fail() { # $*=Error message
+  echo "FAILED: $*"
+  ERR=1
+}
+
+trap 'rm -rf "$TMP"' 0
+mkdir -p "$TMP/src" "$TMP/ref" "$TMP/dst" "$TMP/hs" "$TMP/ht" || exit 1
+cd "$TMP" || exit 1
+
+# Create an identical source and reference file
+echo "v1" > src/f
+cp -p src/f ref/f
+
+# 1st run: The target must be a hard link to the reference file
+"$UPDATE" -L ref src/f dst/ >/dev/null || Fail "update -L returned an error"
+[ "$(ls -i dst/f | cut -d' ' -f1)" = "$(ls -i ref/f | cut -d' ' -f1)" ] || Fail "dst/f is not linked to ref/f"
+
+# 2nd run with a changed source: The reference file must remain unchanged
+sleep 1	# Make sure the source becomes newer than the target
+echo "v2-longer" > src/f
+"$UPDATE" -L ref src/f dst/ >/dev/null || Fail "update -L returned an error"
+[ "$(cat ref/f)" = "v1" ] || Fail "ref/f was overwritten with: $(cat ref/f)"
+[ "$(cat dst/f)" = "v2-longer" ] || Fail "dst/f was not updated: $(cat dst/f)"
+[ "$(ls dst)" = "f" ] || Fail "Unexpected files left in dst:" $(ls dst)
+
+# Without -L, other hard links to the target must be updated too
+echo "old" > ht/a
+ln ht/a ht/b
+sleep 1
+echo "new" > hs/a
+"$UPDATE" hs/a ht/ >/dev/null || Fail "update returned an error"
+[ "$(cat ht/a)" = "new" ] || Fail "ht/a was not updated: $(cat ht/a)"
+[ "$(cat ht/b)" = "new" ] || Fail "The hard link ht/b was broken: $(cat ht/b)"
+
+[ $ERR = 0 ] && echo "update -L test passed"
+exit $ERR
@@ -53,6 +53,19 @@
 *		    Version 2.1.2.					      *
 *    2022-10-19 JFL Moved IsSwitch() to SysLib. Version 2.1.3.		      *
 *    2022-12-12 JFL Removed the line size limitation. Version 2.1.4.	      *
+*    2026-10-18 JFL Trim large files in parallel chunks. Added option -j.     *
+*		    Version 2.2.					      *
+*    2026-10-18 JFL Also trim small files and pipes with the same routine,    *
+*		    using SysLib's StreamFilter() on large blocks, instead of *
+*		    a getline() loop. Version 2.2.1.			      *
+*    2026-10-18 JFL Added option -r to trim all files in a directory tree in  *
+*		    place, with options -n and -x to select them.	      *
+*		    Version 2.3.					      *
+*    2026-10-18 JFL When trimming a file in place, first check if anything    *
+*		    changes, and if not, do not write anything.		      *
+*		    Version 2.3.1.					      *
+*    2026-10-18 JFL Report a missing directory name after option -r as an     *
+*		    error. Version 2.3.2.				      *
 *		                                                              *
 *         © Copyright 2016 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -60,8 +73,8 @@
 
 #define PROGRAM_DESCRIPTION "Remove blanks at the end of lines"
 #define PROGRAM_NAME    "trim"
-#define PROGRAM_VERSION "2.1.4"
-#define PROGRAM_DATE    "2022-12-12"
+#define PROGRAM_VERSION "2.3.2"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -80,6 +93,7 @@
 /* SysToolsLib include files */
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
+#include "parfilter.h"	/* SysLib parallel file filtering routines */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 DEBUG_GLOBALS			/* Define global variables used by our debugging macros */
@@ -165,6 +179,9 @@ void usage(void);                   /* Display a brief help and exit */
 int is_redirected(FILE *f);
 int IsSameFile(char *pszPathname1, char *pszPathname2);
 int file_exists(const char *); 	/* Does this file exist? (TRUE/FALSE) */
+long TrimChunk(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef);
+long TrimFile(FILE *sf, FILE *df, void *pRef);
+void ReportTrimmed(const char *pszPath, long lnChanges, int iErr, void *pRef);
 
 /*---------------------------------------------------------------------------*\
 *                                                                             *
@@ -193,8 +210,6 @@ int main(int argc, char *argv[]) {
   FILE *df = NULL;		/* Destination file pointer */
   char *pszTmpName = NULL;	/* Temporary file name */
   long lnChanges = 0;		/* Number of lines changed */
-  char *line = NULL;		/* The line buffer */
-  size_t lSize = 0;		/* The line buffer size */
   char szBakName[FILENAME_MAX+1];
   int iBackup = FALSE;
   int iSameFile = FALSE;	/* Backup the input file, and modify it in place. */
@@ -203,6 +218,14 @@ int main(int argc, char *argv[]) {
   char *pszPathCopy = NULL;
   char *pszDirName = NULL;	/* Output file directory */
   int iErr;
+  int nThreads = 0;		/* Number of threads. 0 = Automatic */
+  int iParallel;		/* TRUE if filtering in parallel chunks */
+  pf_opts opts = {0};		/* Filtering options */
+  char *pszDir = NULL;		/* Directory tree to trim in place */
+  char **ppszInclude;		/* Name patterns of the files to trim there */
+  char **ppszExclude;		/* Name patterns of the files or dirs to skip */
+  int nInclude = 0;
+  int nExclude = 0;
 
   /* Open a new message file stream for debug and verbose messages */
   if (is_redirected(stdout)) {	/* If stdout is redirected to a file or a pipe */
@@ -221,6 +244,10 @@ int main(int argc, char *argv[]) {
 
   /* Process arguments */
 
+  ppszInclude = calloc(argc, sizeof(char *));
+  ppszExclude = calloc(argc, sizeof(char *));
+  if ((!ppszInclude) || (!ppszExclude)) goto fail_no_mem;
+
   for (i=1; i<argc; i++) {
     char *pszArg = argv[i];
     if (IsSwitch(pszArg)) {		/* It's a switch */
@@ -251,6 +278,19 @@ int main(int argc, char *argv[]) {
 	iCopyTime = TRUE;
 	continue;
       }
+      if (streq(pszOpt, "j") && ((i+1) < argc)) {
+	nThreads = atoi(argv[++i]);
+	continue;
+      }
+      if (streq(pszOpt, "n") && ((i+1) < argc)) {	/* Name pattern to include */
+	ppszInclude[nInclude++] = argv[++i];
+	continue;
+      }
+      if (streq(pszOpt, "r")) {	/* Recursive batch mode */
+	if ((i+1) >= argc) fail("Option -r needs a directory name");
+	pszDir = argv[++i];
+	continue;
+      }
       if (streq(pszOpt, "v") || strieq(pszOpt, "verbose")) {
 	iVerbose = 1;
 	continue;
@@ -259,6 +299,10 @@ int main(int argc, char *argv[]) {
 	puts(DETAILED_VERSION);
 	exit(0);
       }
+      if (streq(pszOpt, "x") && ((i+1) < argc)) {	/* Name pattern to exclude */
+	ppszExclude[nExclude++] = argv[++i];
+	continue;
+      }
       printf("Unrecognized switch %s. Ignored.\n", argv[i]);
       continue;
     }
@@ -275,6 +319,22 @@ int main(int argc, char *argv[]) {
     break;  /* Ignore other arguments */
   }
 
+  if (pszDir) {			/* Trim all matching files in a directory tree */
+    fdt_opts fdtOpts = {0};
+    if (pszInName) fail("Option -r cannot be used with file names");
+    fdtOpts.iFlags = (iBackup ? FF_BACKUP : 0) | (iCopyTime ? FF_SAMETIME : 0);
+    fdtOpts.nThreads = nThreads;
+    if (nInclude) fdtOpts.ppszInclude = ppszInclude;
+    if (nExclude) fdtOpts.ppszExclude = ppszExclude;
+    fdtOpts.pFilterCB = TrimFile;
+    fdtOpts.pReportCB = ReportTrimmed;
+    iErr = FilterDirTree(pszDir, &fdtOpts);
+    if (iErr == -1) return 2;	/* The error has already been reported */
+    fprintf(mf, "%ld files scanned, %ld files changed, %ld lines trimmed\n",
+	    fdtOpts.nFiles, fdtOpts.nChanged, fdtOpts.lnChanges);
+    return iErr ? 2 : 0;
+  }
+
   /* Force stdin and stdout to untranslated */
 #if defined(_MSDOS) || defined(_WIN32)
   _setmode( _fileno( stdin ), _O_BINARY );
@@ -301,6 +361,21 @@ int main(int argc, char *argv[]) {
     iSameFile = IsSameFile(pszInName, pszOutName);
     if (iBackup && !file_exists(pszOutName)) iBackup = FALSE; /* There's nothing to backup */
   }
+  /* Trim large disk files in parallel chunks, else in large blocks */
+  opts.nThreads = nThreads;
+  opts.pSplitCB = PFSplitLines;
+  opts.pProcessCB = TrimChunk;
+  iParallel = UseParallelFilter(sf, nThreads);
+  if (iSameFile) { /* First check if anything changes, without writing anything */
+    iErr = iParallel ? ParallelFilter(sf, NULL, &opts) : StreamFilter(sf, NULL, &opts);
+    if (iErr) fail("Failed to trim %s. %s", pszInName, strerror(errno));
+    if (!opts.lnChanges) { /* Then leave the file untouched */
+      fclose(sf);
+      if (iVerbose) fprintf(mf, "0 lines trimmed\n");
+      return 0;
+    }
+    fseek(sf, 0, SEEK_SET);	/* It does change. Filter it again for good */
+  }
   if (iSameFile || iBackup) { /* Then write to a temporary file */
     int iFile;
     /* But do as if we were writing directly to the target file.
@@ -352,38 +427,13 @@ open_df_failed:
     }
   }
 
-  while (getline(&line, &lSize, sf) >= 0) {
-    int l;
-    int hasCR, hasLF;
-    i = l = (int)strlen(line);
-    /* Is there an \n at the end of the line? */
-    hasLF = ((i) && (line[i-1] == '\n'));
-    if (hasLF) i -= 1;
-    /* Is there an \r at the end of the line? */
-    hasCR = ((i) && (line[i-1] == '\r'));
-    if (hasCR) i -= 1;
-    /* Remove all trailing spaces, tabs, \r and \n */
-    while (i) {
-      i -= 1;             /* Offset of last character in line */
-      if (line[i] == '\r') continue;          /* Return */
-      if (line[i] == '\n') continue;          /* Newline */
-      if (line[i] == ' ') continue;           /* Space */
-      if (line[i] == '\x09') continue;        /* Tab */
-      i += 1;             /* Length of string to preserve */
-      break;
-    }
-    /* Restore the final \r, if initially present */
-    if (hasCR) line[i++] = '\r';
-    /* Restore the final \n, if initially present */
-    if (hasLF) line[i++] = '\n';
-    /* Make sure there's a final NUL */
-    line[i] = '\0';
-    /* Count lines changed */
-    if (i != l) lnChanges += 1;
-
-    fputs(line, df);
+  if (iParallel) {
+    iErr = ParallelFilter(sf, df, &opts);
+  } else {
+    iErr = StreamFilter(sf, df, &opts);
   }
-  if (ferror(sf)) fail("Failed to read %s. %s", strerror(errno));
+  if (iErr) fail("Failed to trim %s. %s", pszInName ? pszInName : "stdin", strerror(errno));
+  lnChanges = opts.lnChanges;
 
   if (sf != stdin) fclose(sf);
   if (df != stdout) fclose(df);
@@ -453,6 +503,111 @@ fail_no_mem:
 #pragma warning(default:4706)
 #endif
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    TrimChunk						      |
+|									      |
+|   Description:    Trim the lines in a block of a file 		      |
+|									      |
+|   Parameters:     const char *pBuf	    The block data		      |
+|		    size_t nBuf 	    Its size			      |
+|		    PFBUF *pOut 	    The output buffer		      |
+|		    void *pRef		    Unused			      |
+|									      |
+|   Returns:	    The number of lines changed, or -1 if out of memory       |
+|									      |
+|   Notes:	    StreamFilter() and ParallelFilter() callback. May run in  |
+|		    worker threads.					      |
+|		    Lines are truncated at the first NUL, like the previous   |
+|		    getline() and fputs() loop did.			      |
+|		    Unchanged lines are copied in runs as long as possible.   |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Also used for serial trimming.			      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long TrimChunk(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef) {
+  const char *pEnd = pBuf + nBuf;
+  const char *pLine = pBuf;
+  const char *pRun = pBuf;	/* Start of the unchanged lines not output yet */
+  long lnChanges = 0;
+
+  while (pLine < pEnd) {
+    const char *pNext = memchr(pLine, '\n', pEnd - pLine);
+    const char *pNul;
+    size_t l, i;
+    int hasCR, hasLF;
+    pNext = pNext ? pNext + 1 : pEnd;
+    i = l = pNext - pLine;
+    pNul = memchr(pLine, '\0', l);
+    if (pNul) i = l = pNul - pLine; /* fputs() stops at the first NUL */
+    hasLF = ((i) && (pLine[i-1] == '\n'));
+    if (hasLF) i -= 1;
+    hasCR = ((i) && (pLine[i-1] == '\r'));
+    if (hasCR) i -= 1;
+    while (i && strchr(" \t\r\n", pLine[i-1])) i -= 1;
+    if ((i + hasCR + hasLF) != l) lnChanges += 1;
+    if (((i + hasCR + hasLF) != l) || pNul) { /* Output the previous run, and this line */
+      if (PFWrite(pOut, pRun, pLine - pRun)) return -1;
+      if (PFWrite(pOut, pLine, i)) return -1;
+      if (hasCR && PFWrite(pOut, "\r", 1)) return -1;
+      if (hasLF && PFWrite(pOut, "\n", 1)) return -1;
+      pRun = pNext;
+    }
+    pLine = pNext;
+  }
+  if (PFWrite(pOut, pRun, pLine - pRun)) return -1;
+  return lnChanges;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    TrimFile						      |
+|									      |
+|   Description:    Trim the lines in a whole file			      |
+|									      |
+|   Parameters:     FILE *sf		    The input file		      |
+|		    FILE *df		    The output file		      |
+|		    void *pRef		    Unused			      |
+|									      |
+|   Returns:	    The number of lines changed, or -1 if failed	      |
+|									      |
+|   Notes:	    FilterDirTree() callback. May run in worker threads.      |
+|		    Files are trimmed in parallel, so each one is trimmed     |
+|		    serially.						      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in callbacks */
+#endif
+
+long TrimFile(FILE *sf, FILE *df, void *pRef) {
+  pf_opts opts = {0};
+  opts.pSplitCB = PFSplitLines;
+  opts.pProcessCB = TrimChunk;
+  if (StreamFilter(sf, df, &opts)) return -1;
+  return opts.lnChanges;
+}
+
+/* FilterDirTree() callback reporting the files changed, and the errors */
+void ReportTrimmed(const char *pszPath, long lnChanges, int iErr, void *pRef) {
+  if (iErr) {
+    fprintf(stderr, "Error: Failed to trim %s. %s\n", pszPath, strerror(iErr));
+  } else if (iVerbose) {
+    fprintf(mf, "%s: %ld lines trimmed\n", pszPath, lnChanges);
+  }
+}
+
+#ifdef _MSC_VER
+#pragma warning(default:4100)
+#endif
+
 /*---------------------------------------------------------------------------*\
 *                                                                             *
 |   Function:	    usage						      |
@@ -472,6 +627,7 @@ void usage(void) {
 PROGRAM_NAME_AND_VERSION " - " PROGRAM_DESCRIPTION "\n\
 \n\
 Usage: trim [SWITCHES] [INFILE [OUTFILE|-=]]\n\
+       trim [SWITCHES] -r DIRECTORY\n\
 \n\
 Switches:\n\
   -b|-bak  Create an *.bak backup file of existing output files\n"
@@ -481,8 +637,13 @@ Switches:\n\
 #endif
 "\
   -=|-same Modify the input file in place. Default: Automatically detected\n\
+  -j N     Trim large files using N threads. Default: 1 per CPU. 1=Serial\n\
+           With -r, trim N files at a time\n\
+  -n NAME  With -r, trim only files matching this wildcard name. Repeatable\n\
+  -r DIR   Trim in place all files in this directory tree, then list totals\n\
   -st      Set the output file time to the same time as the input file\n\
-  -v       Verbose mode\n\
+  -v       Verbose mode. With -r, list the files changed\n\
+  -x NAME  With -r, skip files and dirs matching this wildcard. Repeatable\n\
 \n\
 Arguments:\n\
   INFILE   Input file pathname. Default or \"-\": stdin\n\
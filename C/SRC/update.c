@@ -186,6 +186,29 @@
 *    2023-01-09 JFL Fixed debug builds in MacOS. No change in any other OS.   *
 *    2023-01-10 JFL Changed -R to always display the modification done.       *
 *                   Version 3.14.1.					      *
+*    2026-10-18 JFL Preallocate the target files in copyf().                  *
+*                   Added options -N|--nocache and -W|--window for limiting   *
+*                   the dirty data and cache pollution caused by large copies.*
+*                   Version 3.15.					      *
+*    2026-10-18 JFL Added options -L|--link-dest and -l|--link-compare, to    *
+*                   hard link files identical to those in a reference tree.   *
+*                   Version 3.16.					      *
+*    2026-10-18 JFL Added option -a|--async, to copy small files in batches,  *
+*                   using io_uring in Linux. Version 3.17.		      *
+*    2026-10-18 JFL Clean mode deletes directory trees in parallel threads.   *
+*                   Version 3.18.					      *
+*    2026-10-18 JFL Fixed -L overwriting the reference files, when updating   *
+*                   targets hard-linked to them by a previous run. V. 3.18.1. *
+*    2026-10-18 JFL Reject negative or too large sizes in option -W.          *
+*                   Version 3.18.2.                                           *
+*    2026-10-18 JFL Removed option -a|--async. Benchmarks showed no gain vs.  *
+*                   the usual copies. Version 3.18.3.                         *
+*    2026-10-18 JFL Use SysLib's shared ZapDirTree() report callback.         *
+*                   Version 3.18.4.                                           *
+*    2026-10-18 JFL Only replace -L targets that are the reference file, via  *
+*                   a temporary file. Other hard links are written in place   *
+*                   again. Version 3.18.5.                                    *
+*    2026-10-18 JFL Option -W sizes are always decimal. Version 3.18.6.       *
 *                                                                             *
 *       © Copyright 2016-2018 Hewlett Packard Enterprise Development LP       *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -193,8 +216,8 @@
 
 #define PROGRAM_DESCRIPTION "Update files based on their time stamps"
 #define PROGRAM_NAME    "update"
-#define PROGRAM_VERSION "3.14.1"
-#define PROGRAM_DATE    "2023-01-10"
+#define PROGRAM_VERSION "3.18.6"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -218,6 +241,7 @@
 #include "mainutil.h"	/* SysLib helper routines for main() */
 #include "dirx.h"	/* SysLib Directory access functions eXtensions */
 #include "copyfile.h"	/* SysLib Copy file, and related functions */
+#include "pathnames.h"	/* SysLib Pathname management definitions and functions */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 DEBUG_GLOBALS	/* Define global variables used by debugging macros. (Necessary for Unix builds) */
@@ -312,6 +336,9 @@ char *fullpath(char *absPath, const char *relPath, size_t maxLength);
 #define MAKE_DIR  "mkdir"
 #define DEL_FILE  "rm"
 #define DEL_DIR   "rmdir"
+#define LINK_FILE "ln"
+
+#define HAS_HARDLINKS 1			/* link() is available */
 
 #define _stricmp strcasecmp
 
@@ -378,23 +405,37 @@ static int iRecur = 0;			/* Recursive update */
 static int iClean = 0;			/* Flag indicating Clean mode */
 static int iResetTime = 0;		/* Reset time of identical files */
 static int nobak = FALSE;		/* Flag for skipping backup files */
+static int iNoCache = FALSE;		/* Flag for dropping copied data from the cache */
+static off_t llWindow = 0;		/* Write-behind window size. 0 = Disabled */
+#define DEFAULT_WINDOW (8L * 1024L * 1024L) /* Write-behind window size for -N */
+#if HAS_HARDLINKS
+static char *pszLinkDest = NULL;	/* Reference tree for hard linking identical files */
+static int iLinkCompare = FALSE;	/* Flag for comparing data before linking */
+#endif
 
 /* update() and update_link() functions options */
 typedef struct updOpts {
   int iFlags;				/* Same FLAG_xxx as zapOpts below */
   int *pmdDone;				/* Optional pointer to a flag that records if the target directory has already be created */
+  char *pszRefDir;			/* Optional reference directory for -L. Matches the target directory */
 } updOpts;
 
 /* Forward references */
 
 void usage(void);			/* Display usage */
-int updateall(char *, char *);		/* Copy a set of files if newer */
+int updateall(char *, char *, char *);	/* Copy a set of files if newer */
 int update(char *, char *, updOpts *);	/* Copy a file if newer */
 #if defined(S_ISLNK) && S_ISLNK(S_IFLNK)/* In DOS it's defined, but always returns 0 */
 int update_link(char *, char *, updOpts *);	/* Copy a link if newer */
 #endif
 int copyf(char *, char *);		/* Copy a file silently */
 int copy(char *, char *);		/* Copy a file and display messages */
+#if HAS_HARDLINKS
+int copy_replace(char *, char *, struct stat *); /* Copy a file, replacing the target */
+#endif
+#if HAS_HARDLINKS
+int same_data(char *, char *);		/* Does file 1 have the same data as file 2? */
+#endif
 int mkdirp(const char *path, mode_t mode); /* Same as mkdir -p */
 
 int exists(char *name);			/* Does this pathname exist? (TRUE/FALSE) */
@@ -435,6 +476,7 @@ char *program;	/* This program basename, with extension in Windows */
 char *progcmd;	/* This program invokation name, without extension in Windows */
 int GetProgramNames(char *argv0);	/* Initialize the above two */
 int printError(char *pszFormat, ...);	/* Print errors in a consistent format */
+off_t ParseSize(const char *pszSize);	/* Parse a size with an optional K/M/G suffix */
 
 /* Exit front end, with support for the optional final pause */
 void do_exit(int n) {
@@ -564,6 +606,31 @@ int main(int argc, char *argv[]) {
 	if (iVerbose) printf(COMMENT "Pattern matching = Case-sensitive\n");
 	continue;
       }
+#if HAS_HARDLINKS
+      if (   streq(opt, "l")	    /* Compare the data before linking */
+	  || streq(opt, "-link-compare")) {
+	iLinkCompare = TRUE;
+	if (iVerbose) printf(COMMENT "Compare files before linking = on\n");
+	continue;
+      }
+      if (   streq(opt, "L")	    /* Hard link files identical to those in a reference tree */
+	  || streq(opt, "-link-dest")) {
+	if (((iArg+1) >= argc) || !is_effective_directory(argv[iArg+1])) {
+	  fprintf(stderr, "Error: Invalid reference directory.\n");
+	  do_exit(1);
+	}
+	pszLinkDest = argv[++iArg];
+	if (iVerbose) printf(COMMENT "Link identical files from %s\n", pszLinkDest);
+	continue;
+      }
+#endif
+      if (   streq(opt, "N")	    /* Don't leave copied data in the cache */
+	  || streq(opt, "-nocache")
+	  || streq(opt, "-no-cache")) {
+	iNoCache = TRUE;
+	if (iVerbose) printf(COMMENT "No cache mode = on\n");
+	continue;
+      }
 #ifdef _WIN32
       if (   streq(opt, "O")
 	  || streq(opt, "-oem")) {    /* Force encoding output with the OEM code page */
@@ -639,6 +706,16 @@ int main(int argc, char *argv[]) {
 	puts(DETAILED_VERSION);
 	exit(0);
       }
+      if (   streq(opt, "W")	    /* Write-behind window size */
+	  || streq(opt, "-window")) {
+	if (((iArg+1) >= argc) || ((llWindow = ParseSize(argv[iArg+1])) < 0)) {
+	  fprintf(stderr, "Error: Invalid window size.\n");
+	  do_exit(1);
+	}
+	iArg += 1;
+	if (iVerbose) printf(COMMENT "Write-behind window = %"PRIuMAX" bytes\n", (uintmax_t)llWindow);
+	continue;
+      }
       if (   streq(opt, "X")	    /* NoExec/Test mode on */
 	  || streq(opt, "-noexec")
 	  || streq(opt, "t")) {	    /* The historical name of that switch */
@@ -658,6 +735,8 @@ int main(int argc, char *argv[]) {
     do_exit(1);
   }
 
+  if (iNoCache && !llWindow) llWindow = DEFAULT_WINDOW;
+
   buffer = malloc(BUFFERSIZE);	/* Allocate memory for copying */
   if (!buffer) {
     fprintf(stderr, "Error: Not enough memory.\n");
@@ -740,7 +819,11 @@ int main(int argc, char *argv[]) {
 
   for ( ; iArg < argc; iArg++) { /* For every source file before that */
     arg = argv[iArg];
-    nErrors += updateall(arg, target);
+#if HAS_HARDLINKS
+    nErrors += updateall(arg, target, pszLinkDest);
+#else
+    nErrors += updateall(arg, target, NULL);
+#endif
   }
 
   if (nErrors) { /* Display a final summary, as the errors may have scrolled up beyond view */
@@ -793,6 +876,15 @@ Switches:\n\
   -h|--help|-?  Display this help screen and exit\n\
   -i|--ignorecase    Case-insensitive pattern matching. Default for DOS/Windows\n\
   -k|--casesensitive Case-sensitive pattern matching. Default for Unix\n"
+#if HAS_HARDLINKS
+"\
+  -l|--link-compare  With -L, also compare the files data before linking them\n\
+  -L|--link-dest DIR Hard link files identical to the same file in DIR, instead\n\
+                of copying them. Identical = Same size and time. Ex: Use the\n\
+                previous snapshot of a tree as DIR, to make a new snapshot\n"
+#endif
+"\
+  -N|--nocache  Don't leave the data copied in the cache. Implies -W 8M\n"
 #ifdef _WIN32
 "\
   -O|--oem      Force encoding the output using the OEM character set\n"
@@ -812,6 +904,7 @@ Switches:\n\
 "\
   -v|--verbose  Display extra status information\n\
   -V|--version  Display this program version and exit\n\
+  -W|--window SIZE   Flush large copies to disk every SIZE bytes. Ex: 16M\n\
   -X|-t         Noexec/test mode: Display what would be done, but don't do it\n\
 \n\
 Note: Options -C -D -q -S override each other. The last one provided wins.\n"
@@ -855,6 +948,7 @@ Note: Relative junction targets can be read and set reliably on local drives,\n\
 |                                                                             |
 |   Parameters:     char *p1	    Source path. Wildcards allowed for files. |
 |                   char *p2	    Destination directory		      |
+|                   char *pRef	    Reference directory for -L, or NULL	      |
 |                                                                             |
 |   Return value:   The number of errors encountered. 0=Success               |
 |                                                                             |
@@ -862,11 +956,13 @@ Note: Relative junction targets can be read and set reliably on local drives,\n\
 |                                                                             |
 |   History:								      |
 |    2011-09-06 JFL Added the ability to update to a file with a differ. name.|
+|    2026-10-18 JFL Added the pRef argument.				      |
 *                                                                             *
 \*---------------------------------------------------------------------------*/
 
 int updateall(char *p1,             /* Wildcard * and ? are interpreted */
-	      char *p2)
+	      char *p2,
+	      char *pRef)
     {
 #if _MSDOS /* In DOS, the pathname size is very small, it can be auto-allocated on the stack */
     char path0[PATHNAME_SIZE], path1[PATHNAME_SIZE], path2[PATHNAME_SIZE];
@@ -896,8 +992,9 @@ int updateall(char *p1,             /* Wildcard * and ? are interpreted */
     zo.iFlags |= iFlags;
     uo.iFlags |= iFlags;
     uo.pmdDone = &mdDone;
+    uo.pszRefDir = pRef;
 
-    DEBUG_ENTER(("updateall(\"%s\", \"%s\");\n", p1, p2));
+    DEBUG_ENTER(("updateall(\"%s\", \"%s\", \"%s\");\n", p1, p2, pRef ? pRef : "(null)"));
 
 #ifndef _MSDOS
     path0 = malloc(PATHNAME_SIZE);
@@ -1140,7 +1237,18 @@ int updateall(char *p1,             /* Wildcard * and ? are interpreted */
 	  }
 	}
 
-	err = updateall(path1, path2);
+	if (pRef) {
+	  char *pSubRef = NewPathName(pRef, pDE->d_name); /* Reference subdirectory path */
+	  if (!pSubRef) {
+	    printError("Error: Not enough memory");
+	    nErrors += 1;
+	    continue;	/* Try updating something else */
+	  }
+	  err = updateall(path1, path2, pSubRef);
+	  free(pSubRef);
+	} else {
+	  err = updateall(path1, path2, NULL);
+	}
 	if (err) nErrors += err;
 
 	if (!p2_exists) { /* If we did create the target subdir */
@@ -1189,6 +1297,9 @@ int update(char *p1,	/* Both names must be complete, without wildcards */
     char *p;
     int iCheckOlder = TRUE;
     char path[PATHNAME_SIZE];
+#if HAS_HARDLINKS
+    int iReplace = FALSE;	/* TRUE = The target is the -L reference file. Don't write into it. */
+#endif
 
     DEBUG_ENTER(("update(\"%s\", \"%s\");\n", p1, p2));
 
@@ -1286,6 +1397,44 @@ int update(char *p1,	/* Both names must be complete, without wildcards */
       if (puo && puo->pmdDone) *(puo->pmdDone) = TRUE; /* Avoid displaying this multiple times in test mode */
     }
 
+#if HAS_HARDLINKS
+    /* In link-dest mode, link the reference file if it's identical to the source */
+    if (puo && puo->pszRefDir) {
+      char *pszRef = NewPathName(puo->pszRefDir, strgfn(p2));
+      if (pszRef && same_data(p1, pszRef)) {
+	if (show == SHOW_COMMAND) {
+	  printf(LINK_FILE " \"%s\" \"%s\"\n", pszRef, p2);
+	} else if (show) {
+	  char *name = malloc(PATHNAME_SIZE);
+	  if (name) {
+	    fullpath(name, p, PATHNAME_SIZE); /* Build absolute pathname of file */
+	    printf("%s\n", name);
+	    free(name);
+	  }
+	}
+	err = 0;
+	if (!test) {
+	  if (S_ISREG(sP2stat.st_mode)) unlink(p2); /* Remove the old target file */
+	  err = link(pszRef, p2);
+	  DEBUG_PRINTF(("link(\"%s\", \"%s\"); // %s\n", pszRef, p2, err ? strerror(errno) : "Success"));
+	}
+	free(pszRef);
+	if (!err) RETURN_CONST(0);
+	/* Else the reference is on another file system, or has too many links. Copy it. */
+	if (show == SHOW_COMMAND) printf(COMMENT "Link failed. Copying instead.\n");
+      } else {
+	/* The target may be linked to the reference file by a previous run.
+	   Then writing into it would change the reference too. */
+	struct stat sRefStat;
+	if (   pszRef && S_ISREG(sP2stat.st_mode) && !lstat(pszRef, &sRefStat)
+	    && (sRefStat.st_dev == sP2stat.st_dev) && (sRefStat.st_ino == sP2stat.st_ino)) {
+	  iReplace = TRUE;
+	}
+	free(pszRef);
+      }
+    }
+#endif /* HAS_HARDLINKS */
+
     /* Display what is being copied */
     if (show == SHOW_COMMAND) {
       char *name1 = malloc(PATHNAME_SIZE);
@@ -1305,6 +1454,11 @@ int update(char *p1,	/* Both names must be complete, without wildcards */
 
     if (test == 1) RETURN_CONST(0);
 
+#if HAS_HARDLINKS
+    if (iReplace) {
+      err = copy_replace(p1, p2, &sP2stat);
+    } else
+#endif
     err = copy(p1, p2);
 
     RETURN_INT_COMMENT(err, (err?"Error\n":"Success\n"));
@@ -1489,6 +1643,8 @@ int update_link(char *p1,	/* Both names must be complete, without wildcards */
 |                   When reading fails to start, avoid deleting the target.   |
 |                   In case of error later on, delete incomplete copies.      |
 |    2016-05-10 JFL Added support for the --force option.                     |
+|    2026-10-18 JFL Preallocate the target file, to avoid fragmenting it.     |
+|                   Added the write-behind and no-cache modes.                |
 *                                                                             *
 \*---------------------------------------------------------------------------*/
 
@@ -1505,6 +1661,7 @@ int copyf(char *name1,		    /* Source file to copy from */
     int iWidth = 0;	    /* Number of characters in the iProgress output */
     char *pszUnit = "B";    /* Unit used for iProgress output */
     long lUnit = 1;	    /* Number of bytes for 1 iProgress unit */
+    WRITEBEHIND wb;	    /* Write-behind state for the destination file */
 
     DEBUG_ENTER(("copyf(\"%s\", \"%s\");\n", name1, name2));
     if (iVerbose
@@ -1550,7 +1707,15 @@ retry_open_targetfile:
       fclose(pfs);
       RETURN_INT_COMMENT(2, ("Can't open the output file\n"));
     }
-    /* hdest = fileno(pfd); */
+    /* Reserve the space for the whole file, to avoid fragmenting it */
+    if (PreallocFile(fileno(pfd), filelen)) {
+      if (iShowCopying) printf("\n");
+      fclose(pfs);
+      fclose(pfd);
+      unlink(name2); /* Avoid leaving an empty file on the target */
+      RETURN_INT_COMMENT(2, ("Not enough space for the output file\n"));
+    }
+    InitWriteBehind(&wb, fileno(pfd), llWindow, iNoCache ? WB_NOCACHE : 0);
 
     if (iShowCopying) printf(" : %"PRIuMAX" bytes\n", (uintmax_t)filelen);
 
@@ -1588,9 +1753,16 @@ retry_open_targetfile:
 	unlink(name2); /* Avoid leaving an incomplete file on the target */
         RETURN_INT_COMMENT(2, ("Can't write the output file. Deleted the partial copy.\n"));
       }
+      if (wb.llWindow) { /* Flush the full windows to disk */
+	fflush(pfd);
+	WriteBehind(&wb, offset + tocopy);
+      }
+      if (iNoCache) DropCache(hsource, offset, tocopy);
     }
     if (iProgress && iWidth) printf("%*s\r", iWidth, "");
 
+    fflush(pfd);
+    EndWriteBehind(&wb);
     fclose(pfs);
     fclose(pfd);
 
@@ -1654,6 +1826,64 @@ int copy(char *name1, char *name2) {
   return(e);
 }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    copy_replace					      |
+|                                                                             |
+|   Description:    Copy one file, replacing the target instead of writing it |
+|                                                                             |
+|   Parameters:     char *name1	    Source file pathname                      |
+|                   char *name2	    Destination file pathname		      |
+|                   struct stat *pStat2	Destination file status		      |
+|                                                                             |
+|   Return value:   Same as copyf()					      |
+|                                                                             |
+|   Notes:	    Used when the target is hard-linked to a -L reference     |
+|		    file. The source is copied to a temporary file in the     |
+|		    target directory, which is then renamed as the target.    |
+|		    This breaks the link, without changing the reference.     |
+|		    And the target remains unchanged if the copy fails.	      |
+|                                                                             |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+*                                                                             *
+\*---------------------------------------------------------------------------*/
+
+#if HAS_HARDLINKS
+
+int copy_replace(char *name1, char *name2, struct stat *pStat2) {
+  char *pszTmpName;
+  int iFile;
+  int e;
+
+  DEBUG_ENTER(("copy_replace(\"%s\", \"%s\");\n", name1, name2));
+
+  pszTmpName = malloc(strlen(name2) + 8);
+  if (!pszTmpName) RETURN_INT_COMMENT(2, ("Out of memory\n"));
+  sprintf(pszTmpName, "%s.XXXXXX", name2);
+  iFile = mkstemp(pszTmpName);
+  if (iFile == -1) {
+    free(pszTmpName);
+    RETURN_INT_COMMENT(2, ("Can't create a temporary file\n"));
+  }
+  fchmod(iFile, pStat2->st_mode & 07777); /* Keep the mode of the file replaced */
+  close(iFile);
+
+  e = copyf(name1, pszTmpName);
+  if ((!e) && rename(pszTmpName, name2)) e = 2;
+  DEBUG_PRINTF(("rename(\"%s\", \"%s\"); // %s\n", pszTmpName, name2, e ? strerror(errno) : "Success"));
+  if (e) {
+    int iErrno = errno;
+    unlink(pszTmpName); /* Leave the target unchanged */
+    errno = iErrno;
+  }
+  free(pszTmpName);
+
+  RETURN_INT(e);
+}
+
+#endif /* HAS_HARDLINKS */
+
 /******************************************************************************
 *									      *
 *	File information						      *
@@ -1748,6 +1978,29 @@ int is_effective_directory(char *name){ /* Is name a directory, or a link to a d
   RETURN_BOOL_COMMENT(result, ("%s %s a directory\n", name, result ? "is" : "is not"));
 }
 
+#if HAS_HARDLINKS
+/* Does file p1 have the same data as file p2? Ie. same size and time, or same contents with -l */
+int same_data(char *p1, char *p2)
+    {
+    struct stat st1, st2;
+    int result;
+
+    DEBUG_ENTER(("same_data(\"%s\", \"%s\");\n", p1, p2));
+
+    if (lstat(p2, &st2) || !S_ISREG(st2.st_mode)) {
+      RETURN_BOOL_COMMENT(FALSE, ("No reference file %s\n", p2));
+    }
+    if (lstat(p1, &st1) || (st1.st_size != st2.st_size)) {
+      RETURN_BOOL_COMMENT(FALSE, ("The sizes differ\n"));
+    }
+    /* Same time = Neither file is newer than the other */
+    result = older(p1, p2) && older(p2, p1);
+    if (result && iLinkCompare) result = !filecompare(p1, p2);
+
+    RETURN_BOOL_COMMENT(result, ("File %s is %s file %s\n", p1, result ? "identical to" : "different from", p2));
+    }
+#endif /* HAS_HARDLINKS */
+
 int older(char *p1, char *p2)	/* Is file p1 older than file p2? */
     {
     time_t l1, l2;
@@ -1982,6 +2235,49 @@ off_t _filelength(int hFile) {
 
 #endif /* defined(_UNIX) */
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function:	    ParseSize						      |
+|									      |
+|   Description:    Parse a size, with an optional K/M/G unit suffix	      |
+|									      |
+|   Parameters:     const char *pszSize	The size string. Ex: "16M"	      |
+|									      |
+|   Notes:	    The number is always decimal. So "010M" is 10 MB.	      |
+|									      |
+|   Returns:	    The size in bytes, or -1 if the string is invalid,	      |
+|		    negative, or too large for an off_t.		      |
+|									      |
+|   History:								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Reject negative numbers, and check for overflows.	      |
+|    2026-10-18 JFL Parse decimal numbers only, not octal nor hexadecimal.    |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+off_t ParseSize(const char *pszSize) {
+  char *pszEnd;
+  unsigned long long ullSize;
+  /* The largest positive off_t, computed without overflowing the signed type */
+  unsigned long long ullMax = ((unsigned long long)1 << (8 * sizeof(off_t) - 1)) - 1;
+  int iShift = 0;
+
+  /* Require a digit first. Else strtoull() would accept "-1", and negate it */
+  if ((*pszSize < '0') || (*pszSize > '9')) return -1;
+  errno = 0;
+  ullSize = strtoull(pszSize, &pszEnd, 10);
+  if ((pszEnd == pszSize) || (errno == ERANGE)) return -1;
+  switch (*pszEnd) {
+    case 'G': case 'g': iShift = 30; pszEnd += 1; break;
+    case 'M': case 'm': iShift = 20; pszEnd += 1; break;
+    case 'K': case 'k': iShift = 10; pszEnd += 1; break;
+    default: break;
+  }
+  if (*pszEnd) return -1;
+  if (ullSize > (ullMax >> iShift)) return -1; /* The multiplication would overflow */
+  return (off_t)(ullSize << iShift);
+}
+
 /*---------------------------------------------------------------------------*\
 *                                                                             *
 |  Function	    fullpath						      |
@@ -2269,6 +2565,8 @@ char *NewPathName(const char *path, const char *name) {
 |		    Split zapFile() off of zapDir().			      |
 |		    Added zapXxxM routines, with an additional iMode argument,|
 |		     to avoid unnecessary slow calls to lstat() in Windows.   |
+|    2026-10-18 JFL In Unix, delete the tree with SysLib's ZapDirTree().      |
+|    2026-10-18 JFL Use SysLib's ZapDirTreeReport() callback.		      |
 *									      *
 \*---------------------------------------------------------------------------*/
 
@@ -2345,6 +2643,21 @@ int zapDirM(const char *path, int iMode, zapOpts *pzo) {
     RETURN_INT(1);
   }
 
+  if (!iNoExec) { /* Delete the whole tree in parallel */
+    zdt_opts zdto = {0};
+    zdt_report zdtr = {0};
+    if (iFlags & (FLAG_VERBOSE | FLAG_COMMAND)) zdto.iFlags |= ZDT_VERBOSE;
+    zdtr.iFlags = zdto.iFlags;
+    zdtr.pszPrefix = pzo->pszPrefix;
+    if (iFlags & FLAG_COMMAND) zdtr.pszCommand = DEL_FILE;
+    zdtr.pPrintError = printError;
+    zdto.pReportCB = ZapDirTreeReport;
+    zdto.pRef = &zdtr;
+    nErr = ZapDirTree(path, &zdto);
+    if (nErr >= 0) RETURN_INT_COMMENT(nErr, (nErr ? "%d deletions failed\n" : "Success\n", nErr));
+    nErr = 0; /* ZapDirTree() is not available in this OS. Do it here */
+  }
+
   pDir = opendirx(path);
   if (!pDir) RETURN_INT(1);
   while ((pDE = readdirx(pDir)) != NULL) {
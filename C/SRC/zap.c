@@ -39,13 +39,21 @@
 *    2022-11-27 JFL Added PATHNAME - to get the list of pathnames from stdin. *
 *                   Version 1.6.					      *
 *    2022-12-12 JFL Removed the piped input line size limit. Version 1.6.1.   *
+*    2026-10-18 JFL Delete directory trees in parallel threads in Unix.       *
+*		    Version 1.7.					      *
+*    2026-10-18 JFL Read piped pathnames lists in large blocks, and delete    *
+*		    files relative to their parent directory handle.	      *
+*		    Added option -0 for NUL-separated lists. Version 1.8.     *
+*    2026-10-18 JFL Use SysLib's shared ZapDirTree() report callback, and     *
+*		    delete directories relative to their parent.	      *
+*		    Version 1.8.1.					      *
 *		    							      *
 \*****************************************************************************/
 
 #define PROGRAM_DESCRIPTION "Delete files and/or directories visibly"
 #define PROGRAM_NAME    "zap"
-#define PROGRAM_VERSION "1.6.1"
-#define PROGRAM_DATE    "2022-12-12"
+#define PROGRAM_VERSION "1.8.1"
+#define PROGRAM_DATE    "2026-10-18"
 
 #include "predefine.h" /* Define optional features we need in the C libraries */
 
@@ -61,6 +69,7 @@
 #include "debugm.h"	/* SysToolsLib debug macros. Include first. */
 #include "mainutil.h"	/* SysLib helper routines for main() */
 #include "dirx.h"	/* SysLib Directory access functions eXtensions */
+#include "pathnames.h"	/* SysLib Pathname management definitions and functions */
 #include "stversion.h"	/* SysToolsLib version strings. Include last. */
 
 DEBUG_GLOBALS	/* Define global variables used by our debugging macros */
@@ -77,6 +86,8 @@ DEBUG_GLOBALS	/* Define global variables used by our debugging macros */
 
 #define OS_HAS_DRIVES FALSE
 
+#include <fcntl.h>	/* For openat() */
+
 #endif
 
 /************************ Win32-specific definitions *************************/
@@ -139,7 +150,9 @@ typedef struct zapOpts {
 #define FLAG_NOCASE	0x0008		/* Ignore case */
 #define FLAG_FORCE	0x0010		/* Force operation on read-only files */
 #define FLAG_ZAPBAK	0x0020		/* Zap backup files */
+#define FLAG_NULSEP	0x0040		/* Piped pathnames are NUL-separated */
 int zap(char *arg, zapOpts *pzo); /* Remove whatever the argument refers to */
+int zapList(zapOpts *pzo);	/* Remove all pathnames listed in stdin */
 int zapFiles(const char *pathname, zapOpts *pzo); /* Remove files in a directory */
 int zapBaks(const char *path, zapOpts *pzo); /* Remove backup files in a dir */
 int zapFile(const char *path, zapOpts *pzo); /* Delete a file */
@@ -187,6 +200,10 @@ int main(int argc, char *argv[]) {
 	iProcessSwitches = FALSE;
 	continue;
       }
+      if (streq(opt, "0")) {	/* Piped pathnames are NUL-separated */
+	zo.iFlags |= FLAG_NULSEP;
+	continue;
+      }
       if (streq(opt, "b")) {	/* Zap Backup Files */
 	zo.iFlags |= FLAG_ZAPBAK;
 	continue;
@@ -303,6 +320,7 @@ Usage:\n\
 \n\
 Switches:\n\
   --          End of switches\n\
+  -0          Pathnames from stdin are separated by NULs. Ex: find -print0\n\
   -?|-h       Display this help message and exit\n"
 #ifdef _DEBUG
 "\
@@ -326,6 +344,7 @@ Without a trailing " DIRSEPARATOR_STRING ", wildcards refer to files and links o
 With a trailing " DIRSEPARATOR_STRING ", wildcards refer to directories only.\n\
 \n\
 If PATHNAME is \"-\", then get the list of pathnames to zap from standard input.\n\
+That list has one pathname per line, or separated by NULs with option -0.\n\
 If no argument is provided, and input is not from the console, do like for \"-\".\n\
 Ex: dir /b | findstr /F:/ /C:TOPSECRET /m | zap\n\
 \n\
@@ -698,6 +717,10 @@ int zapBaks(const char *path, zapOpts *pzo) {
 |		    Split zapFile() off of zapDir().			      |
 |		    Added zapXxxM routines, with an additional iMode argument,|
 |		     to avoid unnecessary slow calls to lstat() in Windows.   |
+|    2026-10-18 JFL In Unix, delete the tree with SysLib's ZapDirTree().      |
+|		    It deletes sibling subtrees in parallel threads.	      |
+|		    In NoExec mode, still scan it here, in the usual order.   |
+|    2026-10-18 JFL Use SysLib's ZapDirTreeReport() callback.		      |
 *		    							      *
 \*---------------------------------------------------------------------------*/
 
@@ -788,6 +811,24 @@ int zapDirM(const char *path, int iMode, zapOpts *pzo) {
     goto fail;
   }
 
+  if ((iFlags & FLAG_RECURSE) && !iNoExec) { /* Delete the whole tree in parallel */
+    zdt_opts zdto = {0};
+    zdt_report zdtr = {0};
+    if (iVerbose) zdto.iFlags |= ZDT_VERBOSE;
+    if (streq(GetFileName(path), ".")) zdto.iFlags |= ZDT_KEEPROOT;
+    zdtr.iFlags = zdto.iFlags;
+    zdtr.pszPrefix = pzo->pszPrefix;
+    zdtr.pPrintError = printError;
+    zdto.pReportCB = ZapDirTreeReport;
+    zdto.pRef = &zdtr;
+    nErr = ZapDirTree(path, &zdto);
+    if (nErr >= 0) {
+      if (pzo->pNDeleted) *(pzo->pNDeleted) += zdto.nDeleted;
+      RETURN_INT_COMMENT(nErr, (nErr ? "%d deletions failed\n" : "Success\n", nErr));
+    }
+    nErr = 0; /* ZapDirTree() is not available in this OS. Do it here */
+  }
+
   if (iFlags & FLAG_RECURSE) { /* If in recursive mode, delete everything inside */
     pDir = opendirx(path);
     if (!pDir) goto fail;
@@ -997,23 +1038,7 @@ int zap(char *arg, zapOpts *pzo) {
   size_t l;
   DEBUG_ENTER(("zap(\"%s\", %p);\n", arg, pzo));
   if (!arg) { /* Get the list of files to erase from stdin */
-    char *pszLine = NULL;
-    size_t lSize = 0;
-    int nErr = 0;
-    DEBUG_PRINTF(("// Getting list of pathnames from stdin\n"));
-    while (getline(&pszLine, &lSize, stdin) >= 0) {
-      pszLine[lSize - 1] = '\0';
-      l = strlen(pszLine);
-      for (; l && ((pszLine[l-1]=='\r') || (pszLine[l-1]=='\n')); ) pszLine[--l] = '\0'; /* Trim trailing CR/LF */
-      DEBUG_PRINTF(("pszLine = \"%s\"\n", pszLine));
-      if (pszLine[0]) nErr += zap(pszLine, pzo);
-    }
-    if (ferror(stdin)) {
-      printError("Error reading the piped file list");
-      nErr += 1;
-    }
-    free(pszLine);
-    RETURN_INT(nErr);
+    RETURN_INT(zapList(pzo));
   }
   l = strlen(arg);
 #if defined(_MSDOS) || defined(_WIN32) /* Make sure the path uses only native \ separators */
@@ -1046,3 +1071,162 @@ int zap(char *arg, zapOpts *pzo) {
   RETURN_INT(zapFiles(arg, pzo));
 }
 
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    zapList						      |
+|									      |
+|   Description     Delete all pathnames listed in stdin		      |
+|									      |
+|   Parameters	    zapOpts *pzo    Zap options				      |
+|		    							      |
+|   Returns	    The number of errors encountered			      |
+|		    							      |
+|   Notes	    The input is read in large blocks, and split in place     |
+|		    into lines, or NUL-separated strings with option -0.      |
+|		    							      |
+|		    In Unix, plain files are deleted with unlinkat(), relative|
+|		    to a handle on their parent directory. That handle is     |
+|		    kept open as long as the next pathnames are in the same   |
+|		    directory. Lists generated by find or dir /b /s are       |
+|		    sorted by directory, so this avoids resolving the full    |
+|		    pathname of every file. All other pathnames, and the      |
+|		    files that can't be processed that way, are passed to     |
+|		    zap(), as before.					      |
+|		    							      |
+|   History								      |
+|    2022-11-27 JFL Extracted from routine zap().			      |
+|    2026-10-18 JFL Read stdin in large blocks, and split it in place.        |
+|		    Delete files relative to their parent directory handle.   |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#define LIST_BLOCK_SIZE (1024L * 1024L)	/* Size of the blocks read from stdin */
+
+/* The parent directory handle kept open by zapListed() */
+typedef struct {
+  char *pszDir;		/* Parent directory pathname, or NULL */
+  size_t lDir;		/* Its length */
+  int hDir;		/* Its handle, or -1 if it could not be opened */
+} zapParent;
+
+/* Delete one pathname from the list */
+int zapListed(char *pszLine, size_t l, zapParent *pParent, zapOpts *pzo) {
+#ifdef _UNIX
+  char *pszName;
+  size_t lDir;
+  struct stat sStat;
+  int iFlags = pzo->iFlags;
+#endif
+
+  if (!(pzo->iFlags & FLAG_NULSEP)) { /* Trim trailing CR/LF */
+    for (; l && ((pszLine[l-1]=='\r') || (pszLine[l-1]=='\n')); ) pszLine[--l] = '\0';
+  }
+  if (!l) return 0;
+  DEBUG_PRINTF(("pszLine = \"%s\"\n", pszLine));
+
+#ifdef _UNIX
+  /* Only plain file names can use the fast path. Use zap() for anything else */
+  if (   (iFlags & (FLAG_RECURSE | FLAG_ZAPBAK))
+      || (pszLine[l-1] == DIRSEPARATOR_CHAR)
+      || strpbrk(pszLine, "*?")) return zap(pszLine, pzo);
+  pszName = strrchr(pszLine, DIRSEPARATOR_CHAR);
+  pszName = pszName ? pszName + 1 : pszLine;
+  if (streq(pszName, ".") || streq(pszName, "..")) return zap(pszLine, pzo);
+  lDir = pszName - pszLine;
+
+  /* Reuse the parent directory handle if possible, else open the new parent */
+  if ((!pParent->pszDir) || (lDir != pParent->lDir) || strncmp(pszLine, pParent->pszDir, lDir)) {
+    if (pParent->hDir >= 0) close(pParent->hDir);
+    free(pParent->pszDir);
+    pParent->pszDir = malloc(lDir + 2);
+    if (!pParent->pszDir) return zap(pszLine, pzo);
+    memcpy(pParent->pszDir, pszLine, lDir);
+    pParent->lDir = lDir;
+    strcpy(pParent->pszDir + lDir, lDir ? "" : ".");
+    pParent->hDir = open(pParent->pszDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DEBUG_PRINTF(("open(\"%s\"); // %d\n", pParent->pszDir, pParent->hDir));
+  }
+  if (pParent->hDir < 0) return zap(pszLine, pzo); /* It will report the error */
+
+  if (fstatat(pParent->hDir, pszName, &sStat, AT_SYMLINK_NOFOLLOW)) {
+    if (errno == ENOENT) return 0; /* Already deleted. Not an error. */
+    return zap(pszLine, pzo);
+  }
+  if (S_ISDIR(sStat.st_mode) || S_ISLNK(sStat.st_mode)) return zap(pszLine, pzo);
+
+  if (iFlags & FLAG_VERBOSE) printf("%s%s\n", pzo->pszPrefix, pszLine);
+  if (iFlags & FLAG_NOEXEC) return 0;
+  if (unlinkat(pParent->hDir, pszName, 0)) {
+    printError("Error deleting \"%s\": %s", pszLine, strerror(errno));
+    return 1;
+  }
+  if (pzo->pNDeleted) *(pzo->pNDeleted) += 1; /* Number of files successfully deleted */
+  return 0;
+#else
+  return zap(pszLine, pzo);
+#endif
+}
+
+int zapList(zapOpts *pzo) {
+  char *pBuf;
+  size_t lBuf = LIST_BLOCK_SIZE;
+  size_t lData = 0;	/* Number of bytes in the buffer */
+  char *pLine;
+  char *pEnd;
+  char *pLast;
+  int iEOF = FALSE;
+  int nErr = 0;
+  char cSep = (pzo->iFlags & FLAG_NULSEP) ? '\0' : '\n';
+  zapParent parent = {NULL, 0, -1};
+  int hIn = fileno(stdin);
+
+  DEBUG_ENTER(("zapList(%p);\n", pzo));
+
+  pBuf = malloc(lBuf + 1);
+  if (!pBuf) {
+out_of_memory:
+    printError("Out of memory");
+    RETURN_INT(nErr + 1);
+  }
+  while (!iEOF) {
+    int n;
+    if (lData == lBuf) { /* The line is longer than the buffer. Extend it. */
+      char *pBuf2 = realloc(pBuf, 2*lBuf + 1);
+      if (!pBuf2) {
+	free(pBuf);
+	goto out_of_memory;
+      }
+      pBuf = pBuf2;
+      lBuf *= 2;
+    }
+    n = (int)read(hIn, pBuf + lData, (unsigned)(lBuf - lData));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      printError("Error reading the piped file list");
+      nErr += 1;
+      break;
+    }
+    if (!n) iEOF = TRUE;
+    lData += n;
+    /* Process all complete lines in the buffer */
+    pLast = pBuf + lData;
+    for (pLine = pBuf; (pEnd = memchr(pLine, cSep, pLast - pLine)) != NULL; pLine = pEnd + 1) {
+      *pEnd = '\0';
+      nErr += zapListed(pLine, pEnd - pLine, &parent, pzo);
+    }
+    if (iEOF && (pLine < pLast)) { /* The last line may have no terminator */
+      *pLast = '\0';
+      nErr += zapListed(pLine, pLast - pLine, &parent, pzo);
+      pLine = pLast;
+    }
+    /* Move the incomplete line, if any, to the beginning of the buffer */
+    lData = pLast - pLine;
+    if (lData) memmove(pBuf, pLine, lData);
+  }
+#ifdef _UNIX
+  if (parent.hDir >= 0) close(parent.hDir);
+#endif
+  free(parent.pszDir);
+  free(pBuf);
+  RETURN_INT(nErr);
+}
@@ -0,0 +1,144 @@
+/*****************************************************************************\
+*                                                                             *
+*   File name	    ExpandTabs.c					      *
+*                                                                             *
+*   Description	    Convert tabs to spaces in a block of text		      *
+*                                                                             *
+*   Notes	    Tabs and line feeds are searched 32 or 16 bytes at a time *
+*		    with AVX2 or SSE2 instructions when the compiler targets  *
+*		    them, else one byte at a time. The text between them is   *
+*		    copied in one block, while the column is only computed    *
+*		    modulo the tab width at each tab.			      *
+*		    							      *
+*		    AVX2 is used if the program is built with -mavx2 or	      *
+*		    /arch:AVX2. SSE2 is always available on x86_64.	      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.					      *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent MSVC warnings about unsecure C library functions */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* SysToolsLib include files */
+#include "debugm.h"		/* SysToolsLib debugging macros */
+
+/* SysLib include files */
+#include "parfilter.h"		/* Public definitions for this file */
+
+/* Use the widest vector instructions that the compiler targets.
+   SSE2 is available on all x86_64 processors, and on most recent x86 ones */
+#if defined(__AVX2__)
+#define HAS_AVX2 1
+#define HAS_SSE2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if HAS_SSE2
+#if defined(_MSC_VER)
+#include <intrin.h>
+static int CTZ(unsigned int u) { /* Count trailing zeros. u must not be 0 */
+  unsigned long ul;
+  _BitScanForward(&ul, u);
+  return (int)ul;
+}
+#else
+#define CTZ(u) __builtin_ctz(u)
+#endif
+#endif /* HAS_SSE2 */
+
+/* Find the first tab or line feed. Return pEnd if none */
+static const char *FindTabOrLF(const char *pc, const char *pEnd) {
+#if HAS_AVX2
+  __m256i vTab32 = _mm256_set1_epi8('\t');
+  __m256i vLF32 = _mm256_set1_epi8('\n');
+  while ((pEnd - pc) >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)pc);
+    unsigned int uMask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, vTab32),
+									    _mm256_cmpeq_epi8(v, vLF32)));
+    if (uMask) return pc + CTZ(uMask);
+    pc += 32;
+  }
+#endif
+#if HAS_SSE2
+  {
+    __m128i vTab = _mm_set1_epi8('\t');
+    __m128i vLF = _mm_set1_epi8('\n');
+    while ((pEnd - pc) >= 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)pc);
+      unsigned int uMask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vTab),
+								      _mm_cmpeq_epi8(v, vLF)));
+      if (uMask) return pc + CTZ(uMask);
+      pc += 16;
+    }
+  }
+#endif
+  while ((pc < pEnd) && (*pc != '\t') && (*pc != '\n')) pc++;
+  return pc;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    ExpandTabs						      |
+|									      |
+|   Description     Convert tabs to spaces				      |
+|									      |
+|   Parameters      const char *pIn	The input text			      |
+|		    size_t nIn		Its size			      |
+|		    PFBUF *pOut		The output buffer. Data is appended.  |
+|		    int nTab		Number of columns between tab stops   |
+|		    int *piCol		[IN/OUT] Column modulo nTab. 0=Start  |
+|									      |
+|   Returns	    The number of tabs converted, or -1 if out of memory      |
+|									      |
+|   Notes	    A tab is replaced by 1 to nTab spaces, up to the next     |
+|		    column multiple of nTab. Line feeds reset the column.     |
+|		    All other bytes, including NULs, count for 1 column.      |
+|		    							      |
+|		    *piCol allows converting a text in several blocks, that   |
+|		    do not begin at the beginning of a line.		      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long ExpandTabs(const char *pIn, size_t nIn, PFBUF *pOut, int nTab, int *piCol) {
+  static const char szSpaces[] = "                                "; /* 32 spaces */
+  const char *pEnd = pIn + nIn;
+  const char *pc = pIn;
+  const char *pSpan = pIn;	/* Beginning of the text not output yet */
+  const char *pCol0 = pIn;	/* Where the column was iCol */
+  int iCol = *piCol;
+  long lnTabs = 0;
+
+  while ((pc = FindTabOrLF(pc, pEnd)) < pEnd) {
+    int nSpaces;
+    if (*pc++ == '\n') {	/* A new line begins */
+      pCol0 = pc;
+      iCol = 0;
+      continue;
+    }
+    /* It's a tab. Output the text before it, then the spaces */
+    if (PFWrite(pOut, pSpan, (pc - 1) - pSpan)) return -1;
+    iCol = (int)((iCol + (size_t)((pc - 1) - pCol0)) % (size_t)nTab);
+    for (nSpaces = nTab - iCol; nSpaces > 0; nSpaces -= 32) {
+      if (PFWrite(pOut, szSpaces, (nSpaces < 32) ? nSpaces : 32)) return -1;
+    }
+    pSpan = pCol0 = pc;
+    iCol = 0;
+    lnTabs += 1;
+  }
+  if (PFWrite(pOut, pSpan, pEnd - pSpan)) return -1;
+  *piCol = (int)((iCol + (size_t)(pEnd - pCol0)) % (size_t)nTab);
+  return lnTabs;
+}
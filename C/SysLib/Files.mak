@@ -13,6 +13,12 @@
 #    2016-10-11 JFL moved debugm.h to SysToolsLib global C include dir.       #
 #    2020-03-11 JFL Added Unix-specific object modules.                       #
 #    2024-01-07 JFL Define both NMINCLUDE and STINCLUDE.		      #
+#    2026-10-18 JFL Added copyfile.c.					      #
+#    2026-10-18 JFL Added ZapDirTree.c.					      #
+#    2026-10-18 JFL Added ParallelFilter.c.				      #
+#    2026-10-18 JFL Added StreamFilter.c.				      #
+#    2026-10-18 JFL Added ExpandTabs.c.					      #
+#    2026-10-18 JFL Added FilterDirTree.c.				      #
 #									      #
 #          Copyright 2016 Hewlett Packard Enterprise Development LP          #
 # Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 #
@@ -51,9 +57,15 @@ COMMON_OBJECTS = \
     +$(O)/dict.obj		\
     +$(O)/DupArgLineTail.obj	\
     +$(O)/copydate.obj		\
+    +$(O)/copyfile.obj		\
+    +$(O)/ExpandTabs.obj	\
+    +$(O)/FilterDirTree.obj	\
     +$(O)/JoinPaths.obj		\
+    +$(O)/ParallelFilter.obj	\
     +$(O)/pferror.obj		\
+    +$(O)/StreamFilter.obj	\
     +$(O)/WalkDirTree.obj	\
+    +$(O)/ZapDirTree.obj	\
 
 # Microsoft-OS-specific objects are defined conditionally in SysLib.mak
 # MS_OBJECTS = \
@@ -88,6 +100,8 @@ $(S)/console.h: $(S)/SysLib.h
 
 $(S)/copydate.c: $(S)/SysLib.h $(S)/copyfile.h
 
+$(S)/copyfile.c: $(S)/SysLib.h $(S)/copyfile.h
+
 $(S)/crc32.cpp: $(S)/crc32.h \
 		$(GNUEFI)/inc/efi.h $(GNUEFI)/inc/efilib.h
 
@@ -99,6 +113,8 @@ $(S)/DupArgLineTail.c: $(S)/SysLib.h $(S)/CmdLine.h
 
 $(S)/efibind.h: $(S)/qword.h
 
+$(S)/ExpandTabs.c: $(S)/parfilter.h
+
 $(S)/FDisk95.cpp: $(S)/FloppyDisk.h $(S)/int13.h $(S)/VxDCall.h
 
 $(S)/FDiskDOS.cpp: $(S)/FloppyDisk.h $(S)/int13.h
@@ -111,6 +127,8 @@ $(S)/File.cpp: $(S)/File.h $(S)/FileLibc.cpp $(S)/FileW32.cpp
 
 $(S)/File.h: $(S)/SysLib.h
 
+$(S)/FilterDirTree.c: $(S)/mainutil.h $(S)/parfilter.h $(S)/pathnames.h
+
 $(S)/GetConSize.c: $(S)/console.h
 
 $(S)/GetCurPos.c: $(S)/console.h
@@ -182,6 +200,10 @@ $(S)/OPrintf9.cpp: $(S)/OPrintf.h
 
 $(S)/OPrintf10.cpp: $(S)/OPrintf.h
 
+$(S)/ParallelFilter.c: $(S)/mainutil.h $(S)/parfilter.h
+
+$(S)/parfilter.h: $(S)/SysLib.h
+
 $(S)/PcUuid.c: $(S)/Uuid.h $(S)/smbios.h
 
 $(S)/pferror.c: $(S)/mainutil.h
@@ -208,6 +230,8 @@ $(S)/smbios.c: $(S)/smbios.h
 
 $(S)/smbios.h: $(S)/SysLib.h
 
+$(S)/StreamFilter.c: $(S)/mainutil.h $(S)/parfilter.h
+
 $(S)/stringx.c: $(S)/stringx.h
 
 $(S)/stringx.h: $(S)/SysLib.h
@@ -226,3 +250,5 @@ $(S)/VxDCall.h: $(S)/SysLib.h
 
 $(S)/WalkDirTree.c: $(CI)/dict.h $(CI)/tree.h $(S)/dirx.h $(S)/mainutil.h $(S)/pathnames.h
 
+$(S)/ZapDirTree.c: $(S)/mainutil.h $(S)/pathnames.h
+
@@ -0,0 +1,428 @@
+/*****************************************************************************\
+*                                                                             *
+*   File name	    FilterDirTree.c					      *
+*                                                                             *
+*   Description	    Filter files in place, alone or in a whole directory tree *
+*                                                                             *
+*   Notes	    FilterFileInPlace() writes the filter output to a	      *
+*		    temporary file in the same directory, then replaces the   *
+*		    original file with it, if anything changed.		      *
+*		    It first checks if anything changes, with a read-only     *
+*		    pass, so that unchanged files are just read once.	      *
+*		    							      *
+*		    FilterDirTree() lists the files to filter with	      *
+*		    WalkDirTree(), then filters them with a pool of worker    *
+*		    threads. This allows processing thousands of files in a   *
+*		    single process, without parsing the options every time.  *
+*		    The whole list is built before the first file is changed, *
+*		    so that the temporary files are never listed.	      *
+*		    							      *
+*		    The thread pool is implemented in Unix only. In other     *
+*		    OSs, the files are filtered one at a time.		      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.					      *
+*    2026-10-18 JFL Do not write anything for files that do not change.       *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent MSVC warnings about unsecure C library functions */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <utime.h>
+#include <unistd.h>
+
+/* SysToolsLib include files */
+#include "debugm.h"		/* SysToolsLib debugging macros */
+
+/* SysLib include files */
+#include "pathnames.h"		/* Pathname management definitions and functions */
+#include "mainutil.h"		/* TRUE, FALSE, etc */
+#include "parfilter.h"		/* Public definitions for this file */
+
+#if defined(_MSDOS) || defined(_WIN32)
+
+#include <io.h>
+#define chmod _chmod		/* MSVC thinks this standard routine is not */
+
+#define FDT_MATCH_FLAGS FNM_CASEFOLD	/* File names are case-independent */
+#define IS_DIRSEP(c) (((c) == '\\') || ((c) == '/'))
+#define SAMENAME strieq		/* File name comparison routine */
+
+#else /* Unix */
+
+#define FDT_MATCH_FLAGS 0
+#define IS_DIRSEP(c) ((c) == '/')
+#define SAMENAME streq		/* File name comparison routine */
+
+#endif
+
+#if defined(__unix__) || defined(__MACH__)
+
+#define HAS_FDT_THREADS 1
+
+#define FDT_MAX_THREADS 64
+
+#include <pthread.h>
+
+#endif /* __unix__ */
+
+/* Build the pathname of another file in the same directory as pszPath */
+static char *NewSiblingPath(const char *pszPath, const char *pszName) {
+  size_t lDir = strlen(pszPath);
+  char *pszSibling;
+  while (lDir && !IS_DIRSEP(pszPath[lDir-1])) lDir -= 1;
+  pszSibling = malloc(lDir + strlen(pszName) + 1);
+  if (!pszSibling) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  memcpy(pszSibling, pszPath, lDir);
+  strcpy(pszSibling + lDir, pszName);
+  return pszSibling;
+}
+
+/* Get the base name of a pathname, without modifying it */
+static const char *BaseName(const char *pszPath) {
+  const char *pszName = pszPath + strlen(pszPath);
+  while ((pszName > pszPath) && !IS_DIRSEP(pszName[-1])) pszName -= 1;
+  return pszName;
+}
+
+/* Build the name of the *.bak file for pszPath, in the same directory */
+static char *NewBakPath(const char *pszPath) {
+  const char *pszName = BaseName(pszPath);
+  const char *pszExt = strrchr(pszName, '.');
+  size_t lBase = pszExt ? (size_t)(pszExt - pszPath) : strlen(pszPath);
+  char *pszBak;
+  if (pszExt && SAMENAME(pszExt, ".bak")) {
+    errno = EEXIST;		/* It's a backup already */
+    return NULL;
+  }
+  pszBak = malloc(lBase + 5);
+  if (!pszBak) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  memcpy(pszBak, pszPath, lBase);
+  strcpy(pszBak + lBase, ".bak");
+  return pszBak;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    FilterFileInPlace					      |
+|									      |
+|   Description     Filter a file, and replace it with the output	      |
+|									      |
+|   Parameters      const char *pszPath		The file pathname	      |
+|		    pFileFilterCB pFilterCB	Filter sf into df	      |
+|		    void *pRef			Passed to the callback	      |
+|		    int iFlags			FF_BACKUP | FF_SAMETIME	      |
+|		    							      |
+|   Returns	    The number of changes, or -1 and errno set if failed.     |
+|		    							      |
+|   Notes	    Same semantics as the -same, -bak and -st options of the  |
+|		    trim, detab and remplace tools:			      |
+|		    If nothing changed, the file is left untouched.	      |
+|		    Else FF_BACKUP renames the original file as *.bak,	      |
+|		    else it is deleted. The output file gets the same mode    |
+|		    as the original file. FF_SAMETIME also sets its time.     |
+|		    							      |
+|		    The filter is first run without output, until the first   |
+|		    change. So a file that does not change costs a single     |
+|		    sequential read, without creating any temporary file.     |
+|		    The second pass rereads the changed file from the cache.  |
+|		    							      |
+|		    Thread-safe, provided that the filter callback is.	      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Check if anything changes before writing anything.        |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+long FilterFileInPlace(const char *pszPath, pFileFilterCB pFilterCB, void *pRef, int iFlags) {
+  FILE *sf = NULL;
+  FILE *df = NULL;
+  char *pszTmpName = NULL;
+  char *pszBakName = NULL;
+  struct stat st;
+  long lnChanges = -1;
+  int iFile;
+  int iErrno;
+
+  /* Do as if we were writing directly to the target file.
+     Test the write rights before wasting time on the conversion */
+  sf = fopen(pszPath, "r+b");
+  if (!sf) return -1;
+  if (fstat(fileno(sf), &st)) goto cleanup;
+  if (iFlags & FF_BACKUP) {
+    pszBakName = NewBakPath(pszPath);
+    if (!pszBakName) goto cleanup;
+  }
+
+  /* Check if anything changes */
+  lnChanges = pFilterCB(sf, NULL, pRef);
+  if (lnChanges <= 0) goto cleanup; /* Failed, or nothing changes */
+  lnChanges = -1;
+  if (fseek(sf, 0, SEEK_SET)) goto cleanup;
+
+  /* Filter the file into a temporary file */
+  pszTmpName = NewSiblingPath(pszPath, "dtXXXXXX");
+  if (!pszTmpName) goto cleanup;
+  iFile = mkstemp(pszTmpName);
+  if (iFile == -1) goto cleanup;
+  df = fdopen(iFile, "wb");
+  if (!df) {
+    iErrno = errno;
+    close(iFile);
+    unlink(pszTmpName);
+    errno = iErrno;
+    goto cleanup;
+  }
+
+  lnChanges = pFilterCB(sf, df, pRef);
+  fclose(sf);
+  sf = NULL;
+  if (fclose(df) && (lnChanges >= 0)) lnChanges = -1;
+  df = NULL;
+  if (lnChanges <= 0) {		/* Failed, or nothing changed */
+    iErrno = errno;
+    unlink(pszTmpName); 	/* Remove the temporary output file */
+    errno = iErrno;
+    goto cleanup;
+  }
+
+  if (pszBakName) {		/* Rename the original file as *.bak */
+    if ((unlink(pszBakName) == -1) && (errno != ENOENT)) goto fail_replace;
+    if (rename(pszPath, pszBakName) == -1) goto fail_replace;
+  } else {			/* Don't keep a backup of the original file */
+    if (unlink(pszPath) == -1) goto fail_replace;
+  }
+  if (rename(pszTmpName, pszPath) == -1) goto fail_replace;
+
+  chmod(pszPath, st.st_mode);	/* Copy the file mode flags */
+  if (iFlags & FF_SAMETIME) {	/* Optionally copy the timestamp */
+    struct utimbuf sOutTime = {0};
+    sOutTime.actime = st.st_atime;
+    sOutTime.modtime = st.st_mtime;
+    utime(pszPath, &sOutTime);
+  }
+  goto cleanup;
+
+fail_replace:
+  iErrno = errno;
+  unlink(pszTmpName);
+  errno = iErrno;
+  lnChanges = -1;
+cleanup:
+  iErrno = errno;
+  if (sf) fclose(sf);
+  free(pszTmpName);
+  free(pszBakName);
+  errno = iErrno;
+  return lnChanges;
+}
+
+/* The state shared by the tree walk callback and the worker threads */
+typedef struct {
+  fdt_opts *pOpts;
+  char **ppszList;		/* List of files to filter */
+  long nList;			/* Number of files in the list */
+  long lList;			/* Number of entries allocated */
+  char *pszSkipDir;		/* Excluded directory being walked, if any */
+  long iNext;			/* Index of the next file to filter */
+#if HAS_FDT_THREADS
+  pthread_mutex_t mutex;	/* Protects iNext, the counters, and the report callback */
+#endif
+} fdtState;
+
+/* Check if a name matches one of the patterns in a NULL-terminated list */
+static int MatchesOneOf(const char *pszName, char **ppszPatterns) {
+  for ( ; *ppszPatterns; ppszPatterns++) {
+    if (!fnmatch(*ppszPatterns, pszName, FDT_MATCH_FLAGS)) return TRUE;
+  }
+  return FALSE;
+}
+
+/* WalkDirTree callback: Record the files to filter */
+static int FdtListCB(const char *pszPath, const struct dirent *pDE, void *pRef) {
+  fdtState *ps = pRef;
+  fdt_opts *pOpts = ps->pOpts;
+  const char *pszExt;
+
+  /* The tree is walked depth first. So the contents of an excluded
+     directory come right after it, and all begin with its pathname */
+  if (ps->pszSkipDir) {
+    size_t l = strlen(ps->pszSkipDir);
+    if (!strncmp(pszPath, ps->pszSkipDir, l) && IS_DIRSEP(pszPath[l])) return 0;
+    free(ps->pszSkipDir);
+    ps->pszSkipDir = NULL;
+  }
+  if (pOpts->ppszExclude && MatchesOneOf(pDE->d_name, pOpts->ppszExclude)) {
+    if (pDE->d_type == DT_DIR) {
+      ps->pszSkipDir = strdup(pszPath);
+      if (!ps->pszSkipDir) goto out_of_memory;
+    }
+    return 0;
+  }
+
+  if (pDE->d_type != DT_REG) return 0;
+  if (pOpts->ppszInclude && !MatchesOneOf(pDE->d_name, pOpts->ppszInclude)) return 0;
+  pszExt = strrchr(pDE->d_name, '.');
+  if ((pOpts->iFlags & FF_BACKUP) && pszExt && SAMENAME(pszExt, ".bak")) return 0;
+
+  if (ps->nList == ps->lList) {
+    long lList = ps->lList ? 2 * ps->lList : 256;
+    char **ppszList = realloc(ps->ppszList, lList * sizeof(char *));
+    if (!ppszList) goto out_of_memory;
+    ps->ppszList = ppszList;
+    ps->lList = lList;
+  }
+  ps->ppszList[ps->nList] = strdup(pszPath);
+  if (!ps->ppszList[ps->nList]) goto out_of_memory;
+  ps->nList += 1;
+  return 0;
+
+out_of_memory:
+  pferror("Out of memory");
+  return -1;
+}
+
+/* Filter one file, and report the result */
+static void FdtFilter(fdtState *ps, const char *pszPath) {
+  fdt_opts *pOpts = ps->pOpts;
+  long lnChanges = FilterFileInPlace(pszPath, pOpts->pFilterCB, pOpts->pRef, pOpts->iFlags);
+  int iErr = (lnChanges < 0) ? errno : 0;
+
+#if HAS_FDT_THREADS
+  pthread_mutex_lock(&ps->mutex);
+#endif
+  pOpts->nFiles += 1;
+  if (iErr) {
+    pOpts->nErr += 1;
+  } else if (lnChanges) {
+    pOpts->nChanged += 1;
+    pOpts->lnChanges += lnChanges;
+  }
+  if (pOpts->pReportCB && (iErr || lnChanges)) {
+    pOpts->pReportCB(pszPath, lnChanges, iErr, pOpts->pRef);
+  }
+#if HAS_FDT_THREADS
+  pthread_mutex_unlock(&ps->mutex);
+#endif
+}
+
+/* Worker thread: Filter files until there are none left */
+static void *FdtWorker(void *pParam) {
+  fdtState *ps = pParam;
+  for (;;) {
+    long i;
+#if HAS_FDT_THREADS
+    pthread_mutex_lock(&ps->mutex);
+#endif
+    i = ps->iNext++;
+#if HAS_FDT_THREADS
+    pthread_mutex_unlock(&ps->mutex);
+#endif
+    if (i >= ps->nList) break;
+    FdtFilter(ps, ps->ppszList[i]);
+  }
+  return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    FilterDirTree					      |
+|									      |
+|   Description     Filter in place all matching files in a directory tree    |
+|									      |
+|   Parameters      char *path			The directory pathname	      |
+|		    fdt_opts *pOpts		Options and counters	      |
+|		    							      |
+|   Returns	    The number of errors, or -1 if the tree walk failed.      |
+|		    							      |
+|   Notes	    Only regular files are filtered. Links are not followed.  |
+|		    A file is filtered if its name matches one of the	      |
+|		    include patterns, or if there are none, and if neither    |
+|		    its name, nor that of any of its parent directories,      |
+|		    matches one of the exclude patterns.		      |
+|		    With FF_BACKUP, *.bak files are skipped, as they're	      |
+|		    likely to be the backups of a previous run.		      |
+|		    							      |
+|		    The report callback is invoked for every file changed,    |
+|		    and for every error. The calls are serialized, but come   |
+|		    from any thread, in an unpredictable order.		      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int FilterDirTree(char *path, fdt_opts *pOpts) {
+  fdtState state = {0};
+  wdt_opts wdtOpts = {0};
+  int iRet;
+  long l;
+#if HAS_FDT_THREADS
+  pthread_t hThreads[FDT_MAX_THREADS];
+  int nThreads = pOpts->nThreads;
+  int i;
+#endif
+
+  DEBUG_ENTER(("FilterDirTree(\"%s\");\n", path));
+
+  pOpts->nFiles = 0;
+  pOpts->nChanged = 0;
+  pOpts->lnChanges = 0;
+  pOpts->nErr = 0;
+  state.pOpts = pOpts;
+
+  /* List the files to filter */
+  wdtOpts.iFlags = WDT_CONTINUE;
+  iRet = WalkDirTree(path, &wdtOpts, FdtListCB, &state);
+  free(state.pszSkipDir);
+  if (iRet == -1) goto cleanup;
+  DEBUG_PRINTF(("// Found %ld files to filter\n", state.nList));
+
+  /* Filter them */
+#if HAS_FDT_THREADS
+  if (nThreads <= 0) nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nThreads <= 0) nThreads = 1;
+  if (nThreads > FDT_MAX_THREADS) nThreads = FDT_MAX_THREADS;
+  if (nThreads > state.nList) nThreads = (int)state.nList;
+
+  pthread_mutex_init(&state.mutex, NULL);
+  /* The current thread is one of the workers */
+  for (i=1; i<nThreads; i++) {
+    if (pthread_create(hThreads+i, NULL, FdtWorker, &state)) break;
+  }
+  nThreads = i;
+  DEBUG_PRINTF(("// Using %d threads\n", nThreads));
+  FdtWorker(&state);
+  for (i=1; i<nThreads; i++) pthread_join(hThreads[i], NULL);
+  pthread_mutex_destroy(&state.mutex);
+#else
+  FdtWorker(&state);
+#endif
+  pOpts->nErr += wdtOpts.nErr;
+  iRet = pOpts->nErr;
+
+cleanup:
+  for (l=0; l<state.nList; l++) free(state.ppszList[l]);
+  free(state.ppszList);
+  RETURN_INT_COMMENT(iRet, ("%ld files, %ld changed, %d errors\n", pOpts->nFiles, pOpts->nChanged, pOpts->nErr));
+}
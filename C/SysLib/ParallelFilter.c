@@ -0,0 +1,373 @@
+/*****************************************************************************\
+*                                                                             *
+*   File name	    ParallelFilter.c					      *
+*                                                                             *
+*   Description	    Filter a large file in parallel chunks		      *
+*                                                                             *
+*   Notes	    The main thread reads the input file in large chunks,     *
+*		    each cut at a boundary chosen by the caller, so that it   *
+*		    can be processed independently of the others. Ex: At the  *
+*		    end of a line for line-oriented filters.		      *
+*		    A pool of worker threads processes the chunks into their  *
+*		    own output buffers. The main thread writes these buffers  *
+*		    in the input order, as soon as they're complete.	      *
+*		    So the output is the same as that of a serial filter.     *
+*		    							      *
+*		    There are twice as many chunk slots as threads. This      *
+*		    bounds the memory used, while allowing the main thread to *
+*		    read the next chunks while the previous ones are being    *
+*		    processed.						      *
+*		    							      *
+*		    Implemented in Unix only. In other OSs, ParallelFilter()  *
+*		    filters the file serially with StreamFilter().	      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.					      *
+*    2026-10-18 JFL Fall back to StreamFilter() if no thread can be created.  *
+*		    Look for boundaries again only after the chunk has	      *
+*		    doubled, and pass the size of the new data to the split   *
+*		    callback, to avoid a quadratic search in very long lines. *
+*    2026-10-18 JFL Moved PFWrite() and PFSplitLines() to StreamFilter.c, so  *
+*		    that serial filters do not need to link with pthreads.    *
+*    2026-10-18 JFL Added a check mode, without output.			      *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent MSVC warnings about unsecure C library functions */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* SysToolsLib include files */
+#include "debugm.h"		/* SysToolsLib debugging macros */
+
+/* SysLib include files */
+#include "mainutil.h"		/* TRUE, FALSE, etc */
+#include "parfilter.h"		/* Public definitions for this file */
+
+#if defined(__unix__) || defined(__MACH__)
+
+#define HAS_PARALLELFILTER 1
+
+#define PF_MIN_SIZE (16L * 1024 * 1024) /* Smaller files are not worth the overhead */
+
+#include <unistd.h>
+#include <pthread.h>
+
+#endif /* __unix__ */
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in the stubs */
+#endif
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    UseParallelFilter					      |
+|									      |
+|   Description     Decide if a file should be filtered in parallel	      |
+|									      |
+|   Parameters      FILE *sf		The input file			      |
+|		    int nThreads	Number of threads requested. 0=Auto   |
+|									      |
+|   Returns	    TRUE if ParallelFilter() should be used		      |
+|									      |
+|   Notes	    Only disk files are worth it: Pipes must be processed as  |
+|		    the data comes. By default, only files larger than        |
+|		    PF_MIN_SIZE, in systems with more than one CPU, are	      |
+|		    processed in parallel. nThreads == 1 disables it.	      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#if HAS_PARALLELFILTER
+
+int UseParallelFilter(FILE *sf, int nThreads) {
+  struct stat st;
+
+  if (nThreads == 1) return FALSE;
+  if (fstat(fileno(sf), &st) || !S_ISREG(st.st_mode)) return FALSE;
+  if (nThreads > 1) return TRUE; /* Explicitly requested */
+  if (st.st_size < PF_MIN_SIZE) return FALSE;
+  return (sysconf(_SC_NPROCESSORS_ONLN) > 1);
+}
+
+#else
+
+int UseParallelFilter(FILE *sf, int nThreads) {
+  return FALSE;
+}
+
+#endif /* HAS_PARALLELFILTER */
+
+#if HAS_PARALLELFILTER
+
+#define PF_MAX_THREADS 64
+#ifndef PF_CHUNK_SIZE
+#define PF_CHUNK_SIZE (4L * 1024 * 1024) /* Default chunk size */
+#endif
+
+/* Chunk slot states */
+#define PF_FREE 0		/* Available for reading the next chunk */
+#define PF_READY 1		/* Waiting for a worker thread */
+#define PF_DONE 2		/* Processed. Waiting to be written */
+
+/* A chunk slot */
+typedef struct {
+  PFBUF in;			/* Input data */
+  PFBUF out;			/* Output data */
+  long lnChanges;		/* Number of changes. -1 = Processing failed */
+  int iState;			/* PF_FREE, PF_READY, or PF_DONE */
+} pfSlot;
+
+/* The state shared by all threads */
+typedef struct {
+  pf_opts *pOpts;
+  pthread_mutex_t mutex;	/* Protects everything below */
+  pthread_cond_t cond;		/* Signaled when a slot is ready or done */
+  pfSlot *pSlots;
+  int nSlots;
+  unsigned long ulRead;		/* Number of chunks read so far */
+  unsigned long ulTaken;	/* Number of chunks taken by worker threads */
+  int iEOF;			/* TRUE = No more chunks will be read */
+} pfState;
+
+static void *PfWorker(void *pParam) {
+  pfState *ps = pParam;
+  pf_opts *pOpts = ps->pOpts;
+
+  pthread_mutex_lock(&ps->mutex);
+  while (1) {
+    pfSlot *pSlot;
+    long lnChanges;
+    if (ps->ulTaken == ps->ulRead) {
+      if (ps->iEOF) break;
+      pthread_cond_wait(&ps->cond, &ps->mutex);
+      continue;
+    }
+    pSlot = ps->pSlots + (ps->ulTaken++ % ps->nSlots);
+    pthread_mutex_unlock(&ps->mutex);
+
+    pSlot->out.nBuf = 0;
+    lnChanges = pOpts->pProcessCB(pSlot->in.pBuf, pSlot->in.nBuf, &(pSlot->out), pOpts->pRef);
+
+    pthread_mutex_lock(&ps->mutex);
+    pSlot->lnChanges = lnChanges;
+    pSlot->iState = PF_DONE;
+    pthread_cond_broadcast(&ps->cond);
+  }
+  pthread_mutex_unlock(&ps->mutex);
+  return NULL;
+}
+
+/* Write the oldest chunk. If iWait is FALSE, only if it is done already.
+   Returns 1 if written, 0 if not done yet, -1 if error */
+static int PfWriteNext(pfState *ps, unsigned long *pulWritten, FILE *df, int iWait) {
+  pfSlot *pSlot = ps->pSlots + (*pulWritten % ps->nSlots);
+
+  pthread_mutex_lock(&ps->mutex);
+  while (pSlot->iState != PF_DONE) {
+    if (!iWait) {
+      pthread_mutex_unlock(&ps->mutex);
+      return 0;
+    }
+    pthread_cond_wait(&ps->cond, &ps->mutex);
+  }
+  pthread_mutex_unlock(&ps->mutex);
+
+  *pulWritten += 1;
+  if (pSlot->lnChanges < 0) {
+    errno = ENOMEM;
+    return -1;
+  }
+  ps->pOpts->lnChanges += pSlot->lnChanges;
+  if (df && pSlot->out.nBuf && (fwrite(pSlot->out.pBuf, 1, pSlot->out.nBuf, df) != pSlot->out.nBuf)) {
+    return -1;
+  }
+  pSlot->iState = PF_FREE; /* Only the main thread uses free slots. No need to lock */
+  return 1;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    ParallelFilter					      |
+|									      |
+|   Description     Filter a file using parallel threads		      |
+|									      |
+|   Parameters      FILE *sf		The input file			      |
+|		    FILE *df		The output file, or NULL	      |
+|		    pf_opts *pOpts	Options and callbacks		      |
+|									      |
+|   Returns	    0=Success, else -1 and errno set.			      |
+|									      |
+|   Notes	    If the threads cannot be created, or in OSs without	      |
+|		    pthreads, the file is filtered serially by StreamFilter().|
+|		    							      |
+|		    The input is read with fread(). Do not use this routine   |
+|		    on pipes, as the chunks would be delayed until they're    |
+|		    complete.						      |
+|		    							      |
+|		    If df is NULL, nothing is written, and the filtering      |
+|		    stops as soon as a chunk with changes is found. The       |
+|		    chunks in progress are dropped.			      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Fall back to StreamFilter() if no thread can be created.  |
+|		    When a chunk has no boundary, double its size before      |
+|		    looking again.					      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int ParallelFilter(FILE *sf, FILE *df, pf_opts *pOpts) {
+  pfState state = {0};
+  pthread_t hThreads[PF_MAX_THREADS];
+  PFBUF carry = {0};		/* The input data after the end of the last chunk */
+  unsigned long ulWritten = 0;	/* Number of chunks written */
+  size_t lChunk = pOpts->lChunk ? pOpts->lChunk : PF_CHUNK_SIZE;
+  int nThreads = pOpts->nThreads;
+  int iEOF = FALSE;
+  int iErr = 0;
+  int iRet = 0;
+  int i;
+
+  if (nThreads <= 0) nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nThreads <= 0) nThreads = 1;
+  if (nThreads > PF_MAX_THREADS) nThreads = PF_MAX_THREADS;
+
+  state.pOpts = pOpts;
+  state.nSlots = 2 * nThreads;
+  state.pSlots = calloc(state.nSlots, sizeof(pfSlot));
+  if (!state.pSlots) return -1;
+  pthread_mutex_init(&state.mutex, NULL);
+  pthread_cond_init(&state.cond, NULL);
+  pOpts->lnChanges = 0;
+
+  for (i=0; i<nThreads; i++) {
+    if (pthread_create(hThreads+i, NULL, PfWorker, &state)) break;
+  }
+  nThreads = i;
+  DEBUG_PRINTF(("// Using %d threads and %d slots of %lu bytes\n", nThreads, state.nSlots, (unsigned long)lChunk));
+  if (!nThreads) {
+    free(state.pSlots);
+    pthread_cond_destroy(&state.cond);
+    pthread_mutex_destroy(&state.mutex);
+    return StreamFilter(sf, df, pOpts);
+  }
+
+  while (!iEOF) {
+    pfSlot *pSlot = state.pSlots + (state.ulRead % state.nSlots);
+    size_t nSplit = 0;
+
+    /* Make room by writing the oldest chunk if all slots are in use */
+    if ((state.ulRead - ulWritten) == (unsigned long)state.nSlots) {
+      if (PfWriteNext(&state, &ulWritten, df, TRUE) < 0) goto fail;
+    }
+
+    /* Read the next chunk, beginning with what was left from the previous one */
+    pSlot->in.nBuf = 0;
+    if (PFWrite(&(pSlot->in), carry.pBuf, carry.nBuf)) goto fail;
+    carry.nBuf = 0;
+    while (!nSplit) {
+      size_t nRead;
+      /* Read lChunk bytes, or as much as there is already if there was no boundary in it */
+      size_t nWant = (pSlot->in.nBuf > lChunk) ? pSlot->in.nBuf : lChunk;
+      if ((pSlot->in.lBuf - pSlot->in.nBuf) < nWant) { /* Make room for nWant more bytes */
+	size_t lBuf = pSlot->in.nBuf + nWant;
+	char *pBuf;
+	pBuf = realloc(pSlot->in.pBuf, lBuf);
+	if (!pBuf) {
+	  errno = ENOMEM;
+	  goto fail;
+	}
+	pSlot->in.pBuf = pBuf;
+	pSlot->in.lBuf = lBuf;
+      }
+      nRead = fread(pSlot->in.pBuf + pSlot->in.nBuf, 1, nWant, sf);
+      pSlot->in.nBuf += nRead;
+      if (nRead < nWant) {
+	if (ferror(sf)) goto fail;
+	iEOF = TRUE;
+	nSplit = pSlot->in.nBuf;
+	break;
+      }
+      nSplit = pOpts->pSplitCB(pSlot->in.pBuf, pSlot->in.nBuf, nRead, pOpts->pRef);
+    }
+    if (!pSlot->in.nBuf) break; /* The file size was a multiple of the chunk size */
+    /* Keep what follows the chunk for the next one */
+    if (PFWrite(&carry, pSlot->in.pBuf + nSplit, pSlot->in.nBuf - nSplit)) goto fail;
+    pSlot->in.nBuf = nSplit;
+
+    /* Give the chunk to the worker threads */
+    pthread_mutex_lock(&state.mutex);
+    pSlot->iState = PF_READY;
+    state.ulRead += 1;
+    pthread_cond_signal(&state.cond);
+    pthread_mutex_unlock(&state.mutex);
+
+    /* Write the chunks already done, if any */
+    while ((iRet = PfWriteNext(&state, &ulWritten, df, FALSE)) > 0) ;
+    if (iRet < 0) goto fail;
+    if ((!df) && pOpts->lnChanges) goto drop; /* Check mode, and the file changes */
+  }
+
+  /* Write the remaining chunks */
+  while (ulWritten < state.ulRead) {
+    if (PfWriteNext(&state, &ulWritten, df, TRUE) < 0) goto fail;
+  }
+  iRet = 0;
+  goto cleanup;
+
+fail:
+  iRet = -1;
+  iErr = errno;
+drop:
+  /* Wait for the chunks in progress, and drop them */
+  pthread_mutex_lock(&state.mutex);
+  state.ulRead = state.ulTaken; /* Drop those not taken yet */
+  while (ulWritten < state.ulRead) {
+    pfSlot *pSlot = state.pSlots + (ulWritten % state.nSlots);
+    if (pSlot->iState == PF_DONE) {
+      ulWritten += 1;
+    } else {
+      pthread_cond_wait(&state.cond, &state.mutex);
+    }
+  }
+  pthread_mutex_unlock(&state.mutex);
+
+cleanup:
+  pthread_mutex_lock(&state.mutex);
+  state.iEOF = TRUE;
+  pthread_cond_broadcast(&state.cond);
+  pthread_mutex_unlock(&state.mutex);
+  for (i=0; i<nThreads; i++) pthread_join(hThreads[i], NULL);
+  for (i=0; i<state.nSlots; i++) {
+    free(state.pSlots[i].in.pBuf);
+    free(state.pSlots[i].out.pBuf);
+  }
+  free(state.pSlots);
+  free(carry.pBuf);
+  pthread_cond_destroy(&state.cond);
+  pthread_mutex_destroy(&state.mutex);
+  if (iRet) errno = iErr;
+  return iRet;
+}
+
+#else /* !HAS_PARALLELFILTER */
+
+int ParallelFilter(FILE *sf, FILE *df, pf_opts *pOpts) {
+  return StreamFilter(sf, df, pOpts);
+}
+
+#endif /* HAS_PARALLELFILTER */
@@ -0,0 +1,251 @@
+/*****************************************************************************\
+*                                                                             *
+*   File name	    StreamFilter.c					      *
+*                                                                             *
+*   Description	    Filter a stream in large blocks			      *
+*                                                                             *
+*   Notes	    The serial counterpart of ParallelFilter(), using the     *
+*		    same callbacks. The input is read in large blocks, cut at *
+*		    a boundary chosen by the caller, like the end of the last *
+*		    complete line. The rest is kept for the next block.       *
+*		    Each block is processed in one call, and the output is    *
+*		    written in one call. So the filters need no per-character *
+*		    stdio calls, nor per-line buffer management.	      *
+*		    							      *
+*		    Pipes and consoles are read with read(), which returns    *
+*		    the data as soon as it's available. So the output of      *
+*		    commands in a pipeline still comes out line by line.      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.					      *
+*    2026-10-18 JFL Moved PFWrite() and PFSplitLines() here.		      *
+*    2026-10-18 JFL Added a check mode, without output.			      *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent MSVC warnings about unsecure C library functions */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* SysToolsLib include files */
+#include "debugm.h"		/* SysToolsLib debugging macros */
+
+/* SysLib include files */
+#include "mainutil.h"		/* TRUE, FALSE, etc */
+#include "parfilter.h"		/* Public definitions for this file */
+
+#if defined(_MSDOS)
+
+#include <io.h>
+#define SF_BLOCK_SIZE 0x4000U	/* Keep it well below the 64 KB segment size */
+
+#elif defined(_WIN32)
+
+#include <io.h>
+#define read _read		/* MSVC thinks this standard routine is not */
+
+#else /* Unix */
+
+#include <unistd.h>
+
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in callbacks */
+#endif
+
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+#ifndef SF_BLOCK_SIZE
+#define SF_BLOCK_SIZE 0x100000L	/* Default block size */
+#endif
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    PFWrite						      |
+|									      |
+|   Description     Append data to a growable output buffer		      |
+|									      |
+|   Parameters      PFBUF *pb		The output buffer		      |
+|		    const void *pData	The data to append		      |
+|		    size_t nData	Its size			      |
+|									      |
+|   Returns	    0=Success, else -1 and errno=ENOMEM			      |
+|									      |
+|   Notes	    The buffer size is doubled as needed, so the cost of      |
+|		    reallocations remains proportional to the data size.      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int PFWrite(PFBUF *pb, const void *pData, size_t nData) {
+  if ((pb->nBuf + nData) > pb->lBuf) {
+    size_t lBuf = pb->lBuf ? pb->lBuf : 4096;
+    char *pBuf;
+    while ((pb->nBuf + nData) > lBuf) lBuf *= 2;
+    pBuf = realloc(pb->pBuf, lBuf);
+    if (!pBuf) {
+      errno = ENOMEM;
+      return -1;
+    }
+    pb->pBuf = pBuf;
+    pb->lBuf = lBuf;
+  }
+  memcpy(pb->pBuf + pb->nBuf, pData, nData);
+  pb->nBuf += nData;
+  return 0;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    PFSplitLines					      |
+|									      |
+|   Description     Split callback for line-oriented filters		      |
+|									      |
+|   Parameters      const char *pBuf	The data read so far		      |
+|		    size_t nBuf		Its size			      |
+|		    size_t nNew		Size of the data added since last call|
+|		    void *pRef		Unused				      |
+|									      |
+|   Returns	    The size up to the end of the last complete line, or 0    |
+|									      |
+|   Notes	    The data before the new data contains no line end, else   |
+|		    it would have been in the previous chunk. So don't search |
+|		    it again. This avoids quadratic times on very long lines. |
+|									      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Only search the new data.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+size_t PFSplitLines(const char *pBuf, size_t nBuf, size_t nNew, void *pRef) {
+  size_t nOld = nBuf - nNew;
+  while ((nBuf > nOld) && (pBuf[nBuf-1] != '\n')) nBuf -= 1;
+  return (nBuf > nOld) ? nBuf : 0;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    StreamFilter					      |
+|									      |
+|   Description     Filter a file or a pipe serially, in large blocks	      |
+|									      |
+|   Parameters      FILE *sf		The input file			      |
+|		    FILE *df		The output file, or NULL	      |
+|		    pf_opts *pOpts	Options and callbacks. nThreads unused|
+|									      |
+|   Returns	    0=Success, else -1 and errno set.			      |
+|									      |
+|   Notes	    The input must not have been read by stdio yet, as pipes  |
+|		    bypass the FILE buffer.				      |
+|		    							      |
+|		    When a block contains no boundary, like in the middle of  |
+|		    a very long line, more data is appended to it, and the    |
+|		    split callback is told how much is new.		      |
+|		    							      |
+|		    When the input is not a disk file, the output is flushed  |
+|		    after every block, as more input may be long to come.     |
+|		    							      |
+|		    If df is NULL, nothing is written, and the filtering      |
+|		    stops after the first block with changes. This checks if  |
+|		    a file needs to be changed, without the cost of writing   |
+|		    a copy of it.					      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Added the check mode with df == NULL.		      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int StreamFilter(FILE *sf, FILE *df, pf_opts *pOpts) {
+  PFBUF in = {0};		/* Input data */
+  PFBUF out = {0};		/* Output data */
+  size_t lBlock = pOpts->lChunk ? pOpts->lChunk : SF_BLOCK_SIZE;
+  struct stat st;
+  int isPipe;			/* TRUE if the input is not a disk file */
+  int iEOF = FALSE;
+  int iRet = -1;
+
+  isPipe = (fstat(fileno(sf), &st) || !S_ISREG(st.st_mode));
+  pOpts->lnChanges = 0;
+
+  while (!iEOF) {
+    size_t nRead, nSplit = 0;
+    long lnChanges;
+
+    /* Make room for lBlock more bytes */
+    if ((in.lBuf - in.nBuf) < lBlock) {
+      size_t lBuf = in.nBuf + lBlock;
+      char *pBuf;
+      if (lBuf < (2 * in.lBuf)) lBuf = 2 * in.lBuf; /* Avoid quadratic growth */
+      pBuf = realloc(in.pBuf, lBuf);
+      if (!pBuf) {
+	errno = ENOMEM;
+	goto cleanup;
+      }
+      in.pBuf = pBuf;
+      in.lBuf = lBuf;
+    }
+
+    if (isPipe) {
+      int iRead;
+      do {
+	iRead = (int)read(fileno(sf), in.pBuf + in.nBuf, (unsigned int)lBlock);
+      } while ((iRead == -1) && (errno == EINTR));
+      if (iRead < 0) goto cleanup;
+      nRead = (size_t)iRead;
+    } else {
+      nRead = fread(in.pBuf + in.nBuf, 1, lBlock, sf);
+      if (ferror(sf)) goto cleanup;
+    }
+    in.nBuf += nRead;
+
+    if (!nRead) {		/* End of file. The rest is the last block */
+      iEOF = TRUE;
+      nSplit = in.nBuf;
+      if (!nSplit) break;
+    } else {
+      nSplit = pOpts->pSplitCB(in.pBuf, in.nBuf, nRead, pOpts->pRef);
+    }
+    if (!nSplit) continue;	/* Read more data */
+
+    out.nBuf = 0;
+    lnChanges = pOpts->pProcessCB(in.pBuf, nSplit, &out, pOpts->pRef);
+    if (lnChanges < 0) {
+      errno = ENOMEM;
+      goto cleanup;
+    }
+    pOpts->lnChanges += lnChanges;
+    if (!df) {			/* Check mode */
+      if (lnChanges) break;	/* The file changes. No need to go further */
+    } else {
+      if (out.nBuf && (fwrite(out.pBuf, 1, out.nBuf, df) != out.nBuf)) goto cleanup;
+      if (isPipe) fflush(df); /* Flush the output before waiting for input */
+    }
+
+    /* Move what follows the block to the head of the buffer */
+    in.nBuf -= nSplit;
+    if (in.nBuf) memmove(in.pBuf, in.pBuf + nSplit, in.nBuf);
+  }
+  iRet = 0;
+
+cleanup:
+  free(in.pBuf);
+  free(out.pBuf);
+  return iRet;
+}
@@ -10,6 +10,7 @@
 *    2021-11-27 JFL Created this file.					      *
 *    2022-10-16 JFL Avoid errors in MacOS.				      *
 *    2024-06-21 JFL Added support for detecting already visited paths in Unix.*
+*    2026-10-18 JFL Added an optional depth limit.			      *
 *                                                                             *
 \*****************************************************************************/
 
@@ -182,6 +183,7 @@ char *GetRealName(char *pathname) {
 |		    							      |
 |		    pOpts->WDT_CONTINUE = Treat recoverable errors as warnings|
 |		    pOpts->WDT_QUIET = Don't report warnings & infos	      |
+|		    pOpts->iMaxDepth = Don't recurse deeper than that	      |
 |		    							      |
 |   History								      |
 |    2021-12-14 JFL Created this routine.				      |
@@ -191,6 +193,7 @@ char *GetRealName(char *pathname) {
 |    2022-01-10 JFL Optionally detect alias names for folders visited before. |
 |    2022-01-11 JFL More consistent error handling & better statistics.       |
 |    2024-06-21 JFL Added support for detecting already visited paths in Unix.|
+|    2026-10-18 JFL Added pOpts->iMaxDepth.				      |
 *									      *
 \*---------------------------------------------------------------------------*/
 
@@ -370,7 +373,8 @@ static int WalkDirTree1(char *path, wdt_opts *pOpts, pWalkDirTreeCB_t pWalkDirTr
 	}
 #endif /* OS_HAS_LINKS */
       	if (!list.path) list.path = pPathname;
-      	if (!(pOpts->iFlags & WDT_NORECURSE)) {
+      	if (   !(pOpts->iFlags & WDT_NORECURSE)
+	    && ((!pOpts->iMaxDepth) || ((iDepth+2) <= pOpts->iMaxDepth))) { /* Its entries are at depth iDepth+2 */
 	  if (!list.path) list.path = pPathname;
       	  iRet = WalkDirTree1(pPathname, pOpts, pWalkDirTreeCB, pRef, &list, iDepth+1);
       	}
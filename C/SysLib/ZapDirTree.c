@@ -0,0 +1,388 @@
+/*****************************************************************************\
+*                                                                             *
+*   File name	    ZapDirTree.c					      *
+*                                                                             *
+*   Description	    Delete a whole directory tree, using parallel threads     *
+*                                                                             *
+*   Notes	    The files and directories are deleted with unlinkat(),    *
+*		    and the subdirectories are opened with openat(), relative *
+*		    to an open handle on their parent directory. This avoids  *
+*		    the pathname lookup, and the lstat(), done for every file *
+*		    by the usual opendir/readdir/unlink loop. Each directory  *
+*		    handle remains open until the directory is deleted.	      *
+*		    							      *
+*		    Every subdirectory found is pushed on a stack of pending  *
+*		    directories, which are scanned by a pool of worker	      *
+*		    threads. So sibling subtrees are deleted in parallel.     *
+*		    Each directory keeps a count of its subdirectories not    *
+*		    yet deleted. The last one deleted removes its parent, and *
+*		    so on up to the root. So the tree is deleted bottom-up.   *
+*		    							      *
+*		    Implemented in Unix only. In other OSs, ZapDirTree()      *
+*		    returns -1, and the caller must delete the tree itself.   *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.					      *
+*    2026-10-18 JFL Delete directories with unlinkat() relative to their      *
+*		    parent. Moved zapDirTreeReport() here from zap.c and      *
+*		    update.c, as ZapDirTreeReport().			      *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent MSVC warnings about unsecure C library functions */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+/* SysToolsLib include files */
+#include "debugm.h"		/* SysToolsLib debugging macros */
+
+/* SysLib include files */
+#include "pathnames.h"		/* Pathname management definitions and functions */
+#include "mainutil.h"		/* Print errors, streq, etc */
+
+#if defined(__unix__) || defined(__MACH__)
+
+#define HAS_ZAPDIRTREE 1
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#endif /* __unix__ */
+
+#if HAS_ZAPDIRTREE
+
+#define ZDT_MAX_THREADS 16	/* More threads just contend for the file system locks */
+
+/* A directory to delete */
+typedef struct zdtDir {
+  struct zdtDir *pNext;		/* Next directory in the stack of directories to scan */
+  struct zdtDir *pParent;	/* Parent directory, or NULL for the root */
+  char *pszPath;		/* Pathname of this directory */
+  char *pszName;		/* Its name in its parent directory. Points into pszPath */
+  DIR *pdir;			/* Open handle, kept for its subdirectories, or NULL */
+  int nPending;			/* 1 for its own scan + 1 per subdirectory not yet deleted */
+  int iKeep;			/* TRUE = Do not delete it */
+} zdtDir;
+
+/* The state shared by all threads */
+typedef struct {
+  zdt_opts *pOpts;
+  pthread_mutex_t mutex;	/* Protects everything below, and the report callbacks */
+  pthread_cond_t cond;		/* Signaled when a directory is pushed, or all is done */
+  zdtDir *pTop;			/* Stack of directories to scan */
+  int nBusy;			/* Number of threads scanning a directory */
+} zdtState;
+
+/* Report a deletion or an error, serializing the callbacks */
+static void ZdtReport(zdtState *ps, const char *pszPath, int iType, int iErr) {
+  zdt_opts *pOpts = ps->pOpts;
+  pthread_mutex_lock(&ps->mutex);
+  if (iErr) {
+    pOpts->nErr += 1;
+  } else { /* Other threads may count files without holding the mutex */
+    __atomic_add_fetch(&pOpts->nDeleted, 1, __ATOMIC_RELAXED);
+  }
+  if (pOpts->pReportCB && (iErr || (pOpts->iFlags & ZDT_VERBOSE))) {
+    pOpts->pReportCB(pszPath, iType, iErr, pOpts->pRef);
+  }
+  pthread_mutex_unlock(&ps->mutex);
+}
+
+/* Same thing for a file in a directory. Build its pathname only if needed */
+static void ZdtReportFile(zdtState *ps, zdtDir *pDir, const char *pszName, int iType, int iErr) {
+  zdt_opts *pOpts = ps->pOpts;
+  char *pszPath;
+  if (!iErr && !(pOpts->pReportCB && (pOpts->iFlags & ZDT_VERBOSE))) {
+    __atomic_add_fetch(&pOpts->nDeleted, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  pszPath = NewCompactJoinedPath(pDir->pszPath, pszName);
+  ZdtReport(ps, pszPath ? pszPath : pszName, iType, iErr);
+  free(pszPath);
+}
+
+static zdtDir *ZdtNewDir(char *pszPath, zdtDir *pParent) {
+  zdtDir *pDir = malloc(sizeof(zdtDir));
+  char *pszName;
+  if (!pDir) return NULL;
+  pDir->pNext = NULL;
+  pDir->pParent = pParent;
+  pDir->pszPath = pszPath;
+  pszName = strrchr(pszPath, DIRSEPARATOR_CHAR);
+  pDir->pszName = pszName ? pszName + 1 : pszPath;
+  pDir->pdir = NULL;
+  pDir->nPending = 1;
+  pDir->iKeep = FALSE;
+  return pDir;
+}
+
+/* Release one reference on a directory. The last one deletes it, then releases its parent */
+static void ZdtRelease(zdtState *ps, zdtDir *pDir) {
+  while (pDir && !__atomic_sub_fetch(&pDir->nPending, 1, __ATOMIC_ACQ_REL)) {
+    zdtDir *pParent = pDir->pParent;
+    if (pDir->pdir) closedir(pDir->pdir); /* No subdirectory needs it anymore */
+    if (!pDir->iKeep) {
+      /* The parent directory handle remains open until all its subdirectories
+         are released. The root has none, so use its pathname */
+      int hParent = pParent ? dirfd(pParent->pdir) : AT_FDCWD;
+      const char *pszName = pParent ? pDir->pszName : pDir->pszPath;
+      int iErr = unlinkat(hParent, pszName, AT_REMOVEDIR) ? errno : 0;
+      DEBUG_PRINTF(("unlinkat(%d, \"%s\", AT_REMOVEDIR); // %s\n", hParent, pszName, iErr ? strerror(iErr) : "Success"));
+      ZdtReport(ps, pDir->pszPath, DT_DIR, iErr);
+    }
+    free(pDir->pszPath);
+    free(pDir);
+    pDir = pParent;
+  }
+}
+
+static void ZdtPush(zdtState *ps, zdtDir *pDir) {
+  pthread_mutex_lock(&ps->mutex);
+  pDir->pNext = ps->pTop;
+  ps->pTop = pDir;
+  pthread_cond_signal(&ps->cond);
+  pthread_mutex_unlock(&ps->mutex);
+}
+
+/* Delete all files in a directory, and queue its subdirectories */
+static void ZdtScanDir(zdtState *ps, zdtDir *pDir) {
+  int hDir;
+  DIR *pdir;
+  struct dirent *pDE;
+
+  if (pDir->pParent) { /* Open it relative to its parent, which is still open */
+    hDir = openat(dirfd(pDir->pParent->pdir), pDir->pszName, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  } else {
+    hDir = open(pDir->pszPath, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  }
+  if ((hDir < 0) || !(pdir = fdopendir(hDir))) {
+    ZdtReport(ps, pDir->pszPath, DT_DIR, errno);
+    if (hDir >= 0) close(hDir);
+    pDir->iKeep = TRUE; /* Like zapDirM(), don't try deleting it */
+    ZdtRelease(ps, pDir);
+    return;
+  }
+  /* Keep it open until deleted. Set it before pushing subdirectories, which
+     other threads may begin scanning immediately, relative to this handle */
+  pDir->pdir = pdir;
+  while ((pDE = readdir(pdir)) != NULL) {
+    int iType = pDE->d_type;
+    if (streq(pDE->d_name, ".") || streq(pDE->d_name, "..")) continue;
+    if (iType == DT_UNKNOWN) { /* Some file systems don't return the type */
+      struct stat sStat;
+      if (fstatat(hDir, pDE->d_name, &sStat, AT_SYMLINK_NOFOLLOW)) {
+	ZdtReportFile(ps, pDir, pDE->d_name, iType, errno);
+	continue;
+      }
+      if (S_ISDIR(sStat.st_mode)) iType = DT_DIR;
+      else if (S_ISREG(sStat.st_mode)) iType = DT_REG;
+      else if (S_ISLNK(sStat.st_mode)) iType = DT_LNK;
+    }
+    switch (iType) {
+      case DT_DIR: {
+	char *pszPath = NewCompactJoinedPath(pDir->pszPath, pDE->d_name);
+	zdtDir *pSubDir = pszPath ? ZdtNewDir(pszPath, pDir) : NULL;
+	if (!pSubDir) {
+	  free(pszPath);
+	  ZdtReportFile(ps, pDir, pDE->d_name, iType, ENOMEM);
+	  break;
+	}
+	__atomic_add_fetch(&pDir->nPending, 1, __ATOMIC_RELAXED);
+	ZdtPush(ps, pSubDir);
+	break;
+      }
+      case DT_REG:
+      case DT_LNK: {
+	int iErr = unlinkat(hDir, pDE->d_name, 0) ? errno : 0;
+	ZdtReportFile(ps, pDir, pDE->d_name, iType, iErr);
+	break;
+      }
+      default:	/* We don't support deleting devices, pipes, etc */
+	ZdtReportFile(ps, pDir, pDE->d_name, iType, ENOSYS);
+	break;
+    }
+  }
+  ZdtRelease(ps, pDir); /* Closes pdir if there were no subdirectories */
+}
+
+/* Worker thread: Scan directories until there are none left */
+static void *ZdtWorker(void *pParam) {
+  zdtState *ps = pParam;
+  zdtDir *pDir;
+
+  pthread_mutex_lock(&ps->mutex);
+  for (;;) {
+    while ((!ps->pTop) && ps->nBusy) pthread_cond_wait(&ps->cond, &ps->mutex);
+    if (!ps->pTop) break; /* Nothing left to scan, and nobody can add more */
+    pDir = ps->pTop;
+    ps->pTop = pDir->pNext;
+    ps->nBusy += 1;
+    pthread_mutex_unlock(&ps->mutex);
+    ZdtScanDir(ps, pDir);
+    pthread_mutex_lock(&ps->mutex);
+    ps->nBusy -= 1;
+    if ((!ps->pTop) && (!ps->nBusy)) pthread_cond_broadcast(&ps->cond); /* All done */
+  }
+  pthread_mutex_unlock(&ps->mutex);
+  return NULL;
+}
+
+#endif /* HAS_ZAPDIRTREE */
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    ZapDirTree						      |
+|									      |
+|   Description     Delete a directory and everything it contains	      |
+|									      |
+|   Parameters      const char *path		The directory pathname	      |
+|		    zdt_opts *pOpts		Options and counters	      |
+|		    							      |
+|   Returns	    The number of errors, or -1 if not supported in this OS.  |
+|		    							      |
+|   Notes	    The report callback is invoked for every error, and, with |
+|		    ZDT_VERBOSE, for every file and directory deleted. The    |
+|		    calls are serialized, but come from any thread, in an     |
+|		    unpredictable order. Only a directory is always reported  |
+|		    after everything it contained.			      |
+|		    							      |
+|		    Links are deleted, not followed. Devices, pipes, etc, are |
+|		    not deleted, and are reported as ENOSYS errors, like in   |
+|		    zap.c.						      |
+|		    							      |
+|		    The caller is responsible for checking that the path is   |
+|		    not a root directory.				      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Created this routine				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in the stub */
+#endif
+
+int ZapDirTree(const char *path, zdt_opts *pOpts) {
+#if HAS_ZAPDIRTREE
+  zdtState state;
+  zdtDir *pRoot;
+  char *pszPath;
+  pthread_t hThreads[ZDT_MAX_THREADS];
+  int nThreads = pOpts->nThreads;
+  int i;
+
+  DEBUG_ENTER(("ZapDirTree(\"%s\");\n", path));
+
+  pOpts->nDeleted = 0;
+  pOpts->nErr = 0;
+  if (nThreads <= 0) nThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nThreads <= 0) nThreads = 1;
+  if (nThreads > ZDT_MAX_THREADS) nThreads = ZDT_MAX_THREADS;
+
+  pszPath = strdup(path);
+  pRoot = pszPath ? ZdtNewDir(pszPath, NULL) : NULL;
+  if (!pRoot) {
+    free(pszPath);
+    errno = ENOMEM;
+    RETURN_INT_COMMENT(-1, ("Out of memory\n"));
+  }
+  if (pOpts->iFlags & ZDT_KEEPROOT) pRoot->iKeep = TRUE;
+
+  state.pOpts = pOpts;
+  pthread_mutex_init(&state.mutex, NULL);
+  pthread_cond_init(&state.cond, NULL);
+  state.pTop = pRoot;
+  state.nBusy = 0;
+
+  /* The current thread is one of the workers */
+  for (i=1; i<nThreads; i++) {
+    if (pthread_create(hThreads+i, NULL, ZdtWorker, &state)) break;
+  }
+  nThreads = i;
+  DEBUG_PRINTF(("// Using %d threads\n", nThreads));
+  ZdtWorker(&state);
+  for (i=1; i<nThreads; i++) pthread_join(hThreads[i], NULL);
+
+  pthread_cond_destroy(&state.cond);
+  pthread_mutex_destroy(&state.mutex);
+
+  RETURN_INT_COMMENT(pOpts->nErr, ("%lu deleted, %d errors\n", pOpts->nDeleted, pOpts->nErr));
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function	    ZapDirTreeReport					      |
+|									      |
+|   Description     Standard ZapDirTree() callback, reporting to the console  |
+|									      |
+|   Parameters      const char *path		The file or directory pathname|
+|		    int iType			DT_REG/DT_LNK/DT_DIR/...      |
+|		    int iErr			0 or the errno		      |
+|		    void *pRef			A zdt_report structure	      |
+|		    							      |
+|   Returns	    Nothing						      |
+|		    							      |
+|   Notes	    With ZDT_VERBOSE, lists every pathname, with a suffix     |
+|		    telling its type, like zap does. Or, if pszCommand is     |
+|		    set, lists the command that would delete it.	      |
+|		    Files that could not be deleted are not listed.	      |
+|		    Errors are always displayed on stderr, by the program's   |
+|		    pPrintError() routine if any, else by pferror().	      |
+|		    							      |
+|   History								      |
+|    2026-10-18 JFL Moved zapDirTreeReport() here from zap.c and update.c.    |
+|    2026-10-18 JFL Do not list the files that could not be deleted.	      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+void ZapDirTreeReport(const char *path, int iType, int iErr, void *pRef) {
+  zdt_report *pzr = pRef;
+  char *pszSuffix = "";
+
+  switch (iType) {
+    case DT_REG:
+      break;
+    case DT_DIR:
+      if (path[strlen(path) - 1] != DIRSEPARATOR_CHAR) pszSuffix = DIRSEPARATOR_STRING;
+      break;
+#if defined(S_ISLNK) && S_ISLNK(S_IFLNK) /* In DOS it's defined, but always returns 0 */
+    case DT_LNK:
+      pszSuffix = ">";
+      break;
+#endif
+    default:
+      pszSuffix = "?";
+      break;
+  }
+  /* List directories always, like zapDirM() did. But list other files only
+     if they were deleted. Ex: A FIFO that can't be deleted is not listed. */
+  if ((pzr->iFlags & ZDT_VERBOSE) && (!iErr || (iType == DT_DIR))) {
+    if (pzr->pszCommand) {
+      printf("%s \"%s\"\n", pzr->pszCommand, path);
+    } else {
+      printf("%s%s%s\n", pzr->pszPrefix ? pzr->pszPrefix : "", path, pszSuffix);
+    }
+  }
+  if (iErr) {
+    if (pzr->pPrintError) {
+      pzr->pPrintError("Error deleting \"%s%s\": %s", path, pszSuffix, strerror(iErr));
+    } else {
+      pferror("Can't delete \"%s%s\": %s", path, pszSuffix, strerror(iErr));
+    }
+  }
+}
@@ -0,0 +1,255 @@
+﻿/*****************************************************************************\
+*                                                                             *
+*   Filename        copyfile.c                                                *
+*                                                                             *
+*   Description     Tune the way large file copies use the disk and the cache *
+*                                                                             *
+*   Notes           Preallocating the destination file avoids fragmenting it  *
+*		    on file systems that allocate extents lazily, like ext4   *
+*		    and XFS.						      *
+*		    							      *
+*		    The write-behind routines start flushing every window of  *
+*		    data as soon as it has been written, then wait for the    *
+*		    previous window to be on disk. This bounds the amount of  *
+*		    dirty pages left in the cache by a long copy. Optionally, *
+*		    the pages written are then dropped from the cache, so     *
+*		    that bulk copies do not evict the system's hot data.      *
+*		    							      *
+*		    All routines are no-ops in OSs that have no equivalent    *
+*		    APIs. In this case, the copy works exactly as before.     *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.                                        *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#define _CRT_SECURE_NO_WARNINGS /* Prevent warnings about using fopen, etc */
+
+#define _GNU_SOURCE		/* Include as many extensions as possible */
+#define _FILE_OFFSET_BITS 64	/* Force using 64-bits file sizes if possible */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "debugm.h"		/* SysToolsLib debug macros */
+
+#include "copyfile.h"		/* Public definitions for this file */
+
+/************************* Unix-specific definitions *************************/
+
+#if defined(__linux__)		/* fallocate() and sync_file_range() are Linux-specific */
+
+#define HAS_FALLOCATE 1
+#define HAS_SYNC_FILE_RANGE 1
+#define HAS_FADVISE 1
+
+#elif defined(__unix__) && defined(POSIX_FADV_DONTNEED)
+
+#define HAS_FADVISE 1
+
+#endif /* __unix__ */
+
+#ifdef _MSC_VER
+#pragma warning(disable:4100) /* Ignore the "unreferenced formal parameter" warning in the stubs */
+#endif
+
+/*********************** End of OS-specific definitions **********************/
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function 	    PreallocFile					      |
+|									      |
+|   Description     Reserve the disk space for the final size of a file	      |
+|									      |
+|   Parameters      int hFile		Handle of a file open for writing     |
+|		    off_t llSize	Final file size			      |
+|									      |
+|   Returns 	    0=success, else error and errno set			      |
+|									      |
+|   Notes 	    Only the ENOSPC error is reported. Other errors mean that |
+|		    the file system does not support preallocation. Then the  |
+|		    file will just be extended by the writes as usual.	      |
+|		    							      |
+|		    Do not use posix_fallocate() as a fallback, as it writes  |
+|		    zeros to the file when the file system does not support   |
+|		    preallocation. This would double the amount of I/O.       |
+|		    							      |
+|		    The file size is not changed. It grows with the writes as |
+|		    usual. So if the copy stops early, or if the source file  |
+|		    shrinks, the target does not end with unwritten zeros.    |
+|		    							      |
+|   History 								      |
+|    2026-10-18 JFL Created this routine.				      |
+|    2026-10-18 JFL Use FALLOC_FL_KEEP_SIZE to keep the current file size.    |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int PreallocFile(int hFile, off_t llSize) {
+#if HAS_FALLOCATE
+  int iErr;
+
+  if (llSize <= 0) return 0;
+  iErr = fallocate(hFile, FALLOC_FL_KEEP_SIZE, 0, llSize);
+  DEBUG_PRINTF(("fallocate(%d, FALLOC_FL_KEEP_SIZE, 0, %lld); // %s\n", hFile, (long long)llSize, iErr ? strerror(errno) : "Success"));
+  if (iErr && (errno != ENOSPC)) iErr = 0; /* Not supported by this file system. Never mind. */
+  return iErr;
+#else
+  return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function 	    DropCache						      |
+|									      |
+|   Description     Tell the OS that a range of cached file data is not needed|
+|									      |
+|   Parameters      int hFile		File handle			      |
+|		    off_t llOffset	Start of the range		      |
+|		    off_t llLength	Length of the range. 0 = Up to the end|
+|									      |
+|   Returns 	    0=success, else error and errno set			      |
+|									      |
+|   Notes 	    Dirty pages are not dropped. For files being written, use |
+|		    the write-behind routines below, which flush them first.  |
+|		    							      |
+|   History 								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int DropCache(int hFile, off_t llOffset, off_t llLength) {
+#if HAS_FADVISE
+  int iErr = posix_fadvise(hFile, llOffset, llLength, POSIX_FADV_DONTNEED);
+  if (iErr) {	/* posix_fadvise() returns the error instead of setting errno */
+    errno = iErr;
+    return -1;
+  }
+  return 0;
+#else
+  return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function 	    InitWriteBehind					      |
+|									      |
+|   Description     Initialize the write-behind state for a file	      |
+|									      |
+|   Parameters      WRITEBEHIND *pwb	The write-behind state to initialize  |
+|		    int hFile		Handle of a file open for writing     |
+|		    off_t llWindow	Window size. 0 = No write-behind      |
+|		    int iFlags		WB_NOCACHE = Drop written pages	      |
+|									      |
+|   Returns 	    Nothing						      |
+|									      |
+|   History 								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+void InitWriteBehind(WRITEBEHIND *pwb, int hFile, off_t llWindow, int iFlags) {
+  pwb->hFile = hFile;
+  pwb->llWindow = (llWindow > 0) ? llWindow : 0;
+  pwb->llQueued = 0;
+  pwb->iFlags = iFlags;
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function 	    WriteBehind						      |
+|									      |
+|   Description     Flush the full windows written so far		      |
+|									      |
+|   Parameters      WRITEBEHIND *pwb	The write-behind state		      |
+|		    off_t llWritten	Number of bytes written to the file   |
+|									      |
+|   Returns 	    0=success, else error and errno set			      |
+|									      |
+|   Notes 	    Any user-space buffer, like a stdio FILE buffer, must be  |
+|		    flushed before calling this routine.		      |
+|		    							      |
+|		    For each window completed, start writing it back; Then    |
+|		    wait for the previous window to be on disk, and optionally|
+|		    drop it from the cache. So there are at most two windows  |
+|		    of dirty data in the cache at any time, and the disk is   |
+|		    kept busy while the next window is being filled.	      |
+|		    							      |
+|   History 								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int WriteBehind(WRITEBEHIND *pwb, off_t llWritten) {
+#if HAS_SYNC_FILE_RANGE
+  off_t llWindow = pwb->llWindow;
+  int iErr;
+
+  if (!llWindow) return 0;
+  while ((llWritten - pwb->llQueued) >= llWindow) {
+    /* Start writing back the new window, without waiting */
+    iErr = sync_file_range(pwb->hFile, pwb->llQueued, llWindow, SYNC_FILE_RANGE_WRITE);
+    if (iErr) return iErr;
+    /* Wait for the previous one to be on disk */
+    if (pwb->llQueued) {
+      off_t llPrevious = pwb->llQueued - llWindow;
+      iErr = sync_file_range(pwb->hFile, llPrevious, llWindow, SYNC_FILE_RANGE_WAIT_BEFORE
+							      | SYNC_FILE_RANGE_WRITE
+							      | SYNC_FILE_RANGE_WAIT_AFTER);
+      if (iErr) return iErr;
+      if (pwb->iFlags & WB_NOCACHE) DropCache(pwb->hFile, llPrevious, llWindow);
+    }
+    pwb->llQueued += llWindow;
+  }
+  return 0;
+#else
+  return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*\
+*                                                                             *
+|   Function 	    EndWriteBehind					      |
+|									      |
+|   Description     Flush the rest of the file, if write-behind was used      |
+|									      |
+|   Parameters      WRITEBEHIND *pwb	The write-behind state		      |
+|									      |
+|   Returns 	    0=success, else error and errno set			      |
+|									      |
+|   Notes 	    The tail of the file, after the last full window, is left |
+|		    to the OS to write back, unless the WB_NOCACHE flag is    |
+|		    set. In that case, all data has to be on disk before the  |
+|		    pages can be dropped.				      |
+|		    							      |
+|   History 								      |
+|    2026-10-18 JFL Created this routine.				      |
+*									      *
+\*---------------------------------------------------------------------------*/
+
+int EndWriteBehind(WRITEBEHIND *pwb) {
+#if HAS_SYNC_FILE_RANGE
+  int iErr;
+  off_t llPrevious;
+
+  if (!pwb->llWindow) return 0;
+  if (!(pwb->iFlags & WB_NOCACHE)) return 0;
+  /* Wait for everything from the last window waited for, up to the end of file */
+  llPrevious = pwb->llQueued ? pwb->llQueued - pwb->llWindow : 0;
+  iErr = sync_file_range(pwb->hFile, llPrevious, 0, SYNC_FILE_RANGE_WAIT_BEFORE
+						  | SYNC_FILE_RANGE_WRITE
+						  | SYNC_FILE_RANGE_WAIT_AFTER);
+  if (iErr) return iErr;
+  return DropCache(pwb->hFile, llPrevious, 0);
+#else
+  return 0;
+#endif
+}
@@ -8,6 +8,7 @@
 *                                                                             *
 *   History                                                                   *
 *    2020-11-05 JFL Created this file.                                        *
+*    2026-10-18 JFL Added preallocation and write-behind routines.            *
 *                                                                             *
 *         © Copyright 2020 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -18,6 +19,25 @@
 
 #include "SysLib.h"		/* SysLib Library core definitions */
 
+#include <sys/types.h>		/* For off_t */
+
 int copydate(const char *pszToFile, const char *pszFromFile); /* Copy the file dates */
 
+/* Large file copy tuning. These are no-ops in OSs that don't support them. */
+int PreallocFile(int hFile, off_t llSize); /* Reserve space for the final file size */
+int DropCache(int hFile, off_t llOffset, off_t llLength); /* Drop clean cached data */
+
+/* Write-behind state, for limiting the dirty data left in the cache by long copies */
+typedef struct {
+  int hFile;			/* The file being written */
+  int iFlags;			/* WB_xxx flags below */
+  off_t llWindow;		/* Write-behind window size. 0 = Disabled */
+  off_t llQueued;		/* Offset up to which writes have been started */
+} WRITEBEHIND;
+#define WB_NOCACHE 0x0001	/* Drop the pages written from the cache */
+
+void InitWriteBehind(WRITEBEHIND *pwb, int hFile, off_t llWindow, int iFlags);
+int WriteBehind(WRITEBEHIND *pwb, off_t llWritten); /* Flush the full windows written so far */
+int EndWriteBehind(WRITEBEHIND *pwb); /* Flush the rest in WB_NOCACHE mode */
+
 #endif /* _COPYFILE_H_ */
@@ -0,0 +1,96 @@
+/*****************************************************************************\
+*                                                                             *
+*   Filename        parfilter.h                                               *
+*                                                                             *
+*   Description     Definitions for parallel file filtering routines         *
+*                                                                             *
+*   Notes           							      *
+*                                                                             *
+*   History                                                                   *
+*    2026-10-18 JFL Created this file.                                        *
+*    2026-10-18 JFL Added StreamFilter().                                     *
+*    2026-10-18 JFL Added ExpandTabs().                                       *
+*    2026-10-18 JFL Added FilterFileInPlace() and FilterDirTree().            *
+*    2026-10-18 JFL Added the check mode, with a NULL output file.            *
+*                                                                             *
+*         © Copyright 2026 Hewlett Packard Enterprise Development LP          *
+* Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
+\*****************************************************************************/
+
+#ifndef _PARFILTER_H_
+#define _PARFILTER_H_
+
+#include "SysLib.h"		/* SysLib Library core definitions */
+
+#include <stdio.h>		/* For FILE */
+#include <stddef.h>		/* For size_t */
+
+/* A growable output buffer */
+typedef struct {
+  char *pBuf;			/* The data */
+  size_t nBuf;			/* Number of bytes used */
+  size_t lBuf;			/* Number of bytes allocated */
+} PFBUF;
+
+int PFWrite(PFBUF *pb, const void *pData, size_t nData); /* Append data. 0=Success, -1=ENOMEM */
+
+/* Return the size of the longest prefix of pBuf that can be processed
+   independently of what follows. 0 = None found, read more data.
+   nNew = Number of bytes at the end of pBuf, that were not in the pBuf
+   passed to the previous call. */
+typedef size_t (*pPFSplitCB)(const char *pBuf, size_t nBuf, size_t nNew, void *pRef);
+/* Process one chunk. Append the output to pOut. Return the number of
+   changes done, or -1 if out of memory */
+typedef long (*pPFProcessCB)(const char *pBuf, size_t nBuf, PFBUF *pOut, void *pRef);
+
+typedef struct {		/* ParallelFilter options. Must be cleared before use. */
+  int nThreads;			/* [IN] Number of threads. 0 = One per CPU */
+  size_t lChunk;		/* [IN] Chunk size. 0 = Default */
+  pPFSplitCB pSplitCB;		/* [IN] Find the end of a chunk */
+  pPFProcessCB pProcessCB;	/* [IN] Process a chunk */
+  void *pRef;			/* [IN] Reference data passed to the callbacks */
+  long lnChanges;		/* [OUT] Sum of the changes done in all chunks */
+} pf_opts;
+
+/* Filter sf into df. Returns 0=Success, -1=Error.
+   If df is NULL, write nothing, and stop at the first chunk with changes. */
+int ParallelFilter(FILE *sf, FILE *df, pf_opts *pOpts); /* For large disk files */
+int StreamFilter(FILE *sf, FILE *df, pf_opts *pOpts);	/* Serial version, also for pipes */
+int UseParallelFilter(FILE *sf, int nThreads); /* Is sf worth filtering in parallel? */
+size_t PFSplitLines(const char *pBuf, size_t nBuf, size_t nNew, void *pRef); /* pSplitCB for line filters */
+
+/* Text filtering kernels */
+long ExpandTabs(const char *pIn, size_t nIn, PFBUF *pOut, int nTab, int *piCol); /* Convert tabs to spaces */
+
+/* In-place file filtering */
+
+/* FilterFileInPlace option flags */
+#define FF_BACKUP	0x0001		/* Rename the original file as *.bak */
+#define FF_SAMETIME	0x0002		/* Keep the original file time, even if it changed */
+
+/* Filter sf into df. Return the number of changes, or -1 and errno if failed.
+   If df is NULL, only check if anything changes: Write nothing, and return
+   a positive number as soon as a change is found. */
+typedef long (*pFileFilterCB)(FILE *sf, FILE *df, void *pRef);
+
+/* Report callback. lnChanges = Number of changes, or -1 if failed with errno = iErr */
+typedef void (*pFilterDirTreeCB)(const char *pszPath, long lnChanges, int iErr, void *pRef);
+
+typedef struct {		/* FilterDirTree options. Must be cleared before use. */
+  int iFlags;			/* [IN] FF_xxx options for every file */
+  int nThreads;			/* [IN] Number of threads. 0 = One per CPU */
+  char **ppszInclude;		/* [IN] NULL-terminated list of name patterns to filter. NULL = All */
+  char **ppszExclude;		/* [IN] NULL-terminated list of file or directory name patterns to skip */
+  pFileFilterCB pFilterCB;	/* [IN] Filter one file */
+  pFilterDirTreeCB pReportCB;	/* [IN] Optional callback reporting changed files and errors */
+  void *pRef;			/* [IN] Reference data passed to the callbacks */
+  long nFiles;			/* [OUT] Number of files filtered */
+  long nChanged;		/* [OUT] Number of files changed */
+  long lnChanges;		/* [OUT] Sum of the changes done in all files */
+  int nErr;			/* [OUT] Number of errors */
+} fdt_opts;
+
+long FilterFileInPlace(const char *pszPath, pFileFilterCB pFilterCB, void *pRef, int iFlags); /* Returns the # of changes, or -1 */
+int FilterDirTree(char *path, fdt_opts *pOpts); /* Returns the # of errors, or -1 */
+
+#endif /* _PARFILTER_H_ */
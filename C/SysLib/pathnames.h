@@ -8,6 +8,9 @@
 *		    							      *
 *   History:								      *
 *    2021-12-15 JFL Created this file.					      *
+*    2026-10-18 JFL Added ZapDirTree definitions.			      *
+*    2026-10-18 JFL Added ZapDirTreeReport() definitions.		      *
+*    2026-10-18 JFL Added wdt_opts.iMaxDepth.				      *
 *									      *
 *         © Copyright 2021 Hewlett Packard Enterprise Development LP          *
 * Licensed under the Apache 2.0 license - www.apache.org/licenses/LICENSE-2.0 *
@@ -95,6 +98,7 @@ char *NewCompactJoinedPath(const char *pszPart1, const char *pszPart2);	/* Idem,
 
 typedef struct {		/* WalkDirTree options. Must be cleared before use. */
   int iFlags;			/* [IN] Options */
+  int iMaxDepth;		/* [IN] Max depth of entries reported. 1=Only those in path. 0=No limit */
   ino_t nDir;			/* [OUT] Number of directories scanned */
   ino_t nFile;			/* [OUT] Number of directory entries processed */
   int nErr;			/* [OUT] Number of errors */
@@ -105,6 +109,35 @@ typedef int (*pWalkDirTreeCB_t)(const char *pszRelPath, const struct dirent *pDE
 
 extern int WalkDirTree(char *path, wdt_opts *pOpts, pWalkDirTreeCB_t pWalkDirTreeCB, void *pRef);
 
+/* ZapDirTree definitions */
+
+/* ZapDirTree option flags */
+#define ZDT_VERBOSE	0x0001		/* Report every file and directory deleted */
+#define ZDT_KEEPROOT	0x0002		/* Delete the directory contents, but not the directory itself */
+
+/* Report callback. iType = DT_REG/DT_LNK/DT_DIR/...; iErr = 0 or the errno */
+typedef void (*pZapDirTreeCB_t)(const char *pszPath, int iType, int iErr, void *pRef);
+
+typedef struct {		/* ZapDirTree options. Must be cleared before use. */
+  int iFlags;			/* [IN] Options */
+  int nThreads;			/* [IN] Number of threads. 0 = One per CPU */
+  pZapDirTreeCB_t pReportCB;	/* [IN] Optional callback reporting deletions and errors */
+  void *pRef;			/* [IN] Reference data passed to the callback */
+  unsigned long nDeleted;	/* [OUT] Number of files and directories deleted */
+  int nErr;			/* [OUT] Number of errors */
+} zdt_opts;
+
+extern int ZapDirTree(const char *path, zdt_opts *pOpts);
+
+typedef struct {		/* ZapDirTreeReport() options, passed as the callback pRef */
+  int iFlags;			/* [IN] ZDT_VERBOSE = List every pathname deleted */
+  const char *pszPrefix;	/* [IN] Prefix for the pathnames listed, or NULL */
+  const char *pszCommand;	/* [IN] If not NULL, list this command + pathname instead */
+  int (*pPrintError)(char *pszFormat, ...); /* [IN] The program's error display routine, or NULL */
+} zdt_report;
+
+extern void ZapDirTreeReport(const char *path, int iType, int iErr, void *pRef); /* Standard callback */
+
 #ifdef __cplusplus
 }
 #endif /* defined(__cplusplus) */